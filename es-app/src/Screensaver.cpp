@@ -28,15 +28,22 @@
 #endif
 
 #define IMAGES_FADE_IN_TIME 450.0f
+// Number of recently played videos that are avoided when all videos have been played and the
+// random selection starts over, at most half of the available videos are excluded.
+#define RECENT_VIDEOS_HISTORY 10
 
 Screensaver::Screensaver()
     : mRenderer {Renderer::getInstance()}
     , mWindow {Window::getInstance()}
     , mImageScreensaver {nullptr}
     , mVideoScreensaver {nullptr}
+    , mNextVideoScreensaver {nullptr}
+    , mNextVideoGame {nullptr}
+    , mRandomEngine {std::random_device {}()}
     , mCurrentGame {nullptr}
     , mPreviousGame {nullptr}
     , mTimer {0}
+    , mUnplayedVideoCount {0}
     , mMediaSwapTime {0}
     , mScreensaverActive {false}
     , mTriggerNextGame {false}
@@ -143,42 +150,50 @@ void Screensaver::startScreensaver(bool generateMediaList)
     else if (!mVideoScreensaver && (mScreensaverType == "video")) {
         if (generateMediaList) {
             mVideoFiles.clear();
-            mFilesInventory.clear();
+            mRecentVideos.clear();
+            mUnplayedVideoCount = 0;
+            mNextVideoScreensaver.reset();
+            mNextVideoGame = nullptr;
         }
 
         mMediaSwapTime = Settings::getInstance()->getInt("ScreensaverSwapVideoTimeout");
 
-        // Load a random video.
         if (generateMediaList)
             generateVideoList();
-        pickRandomVideo(path);
-
-        // We've cycled through all games, so start from the beginning again.
-        if (mVideoFiles.size() == 0 && mFilesInventory.size() > 0)
-            mVideoFiles.insert(mVideoFiles.begin(), mFilesInventory.begin(), mFilesInventory.end());
 
         if (mVideoFiles.size() > 0)
             mHasMediaFiles = true;
 
-        if (!path.empty() && Utils::FileSystem::exists(path)) {
+        // Use the prefetched video if there is one, otherwise load a random video.
+        if (mNextVideoScreensaver) {
+            mCurrentGame = mNextVideoGame;
+            mVideoScreensaver = std::move(mNextVideoScreensaver);
+        }
+        else {
+            mCurrentGame = pickRandomVideo();
+            if (mCurrentGame != nullptr)
+                mVideoScreensaver = createVideoScreensaver(mCurrentGame->getVideoPath());
+        }
+
+        mNextVideoGame = nullptr;
+
+        if (mVideoScreensaver) {
+            mGameName = mCurrentGame->getName();
+            mSystemName = mCurrentGame->getSystem()->getFullName();
+
             if (Settings::getInstance()->getBool("ScreensaverVideoGameInfo"))
                 generateOverlayInfo();
 
-            mVideoScreensaver = std::make_unique<VideoFFmpegComponent>();
-            mVideoScreensaver->setOrigin(0.5f, 0.5f);
-            mVideoScreensaver->setPosition(Renderer::getScreenWidth() / 2.0f,
-                                           Renderer::getScreenHeight() / 2.0f);
+            mVideoScreensaver->startVideoPlayer();
 
-            if (Settings::getInstance()->getBool("ScreensaverStretchVideos"))
-                mVideoScreensaver->setResize(Renderer::getScreenWidth(),
-                                             Renderer::getScreenHeight());
-            else
-                mVideoScreensaver->setMaxSize(Renderer::getScreenWidth(),
-                                              Renderer::getScreenHeight());
+            // Prefetch the next video, unless it's the same video that is now playing.
+            FileData* nextGame {pickRandomVideo()};
+            if (nextGame != nullptr && nextGame != mCurrentGame) {
+                mNextVideoScreensaver = createVideoScreensaver(nextGame->getVideoPath());
+                if (mNextVideoScreensaver)
+                    mNextVideoGame = nextGame;
+            }
 
-            mVideoScreensaver->setVideo(path);
-            mVideoScreensaver->setScreensaverMode(true);
-            mVideoScreensaver->startVideoPlayer();
             mTimer = 0;
             return;
         }
@@ -191,6 +206,8 @@ void Screensaver::stopScreensaver()
 {
     mImageScreensaver.reset();
     mVideoScreensaver.reset();
+    mNextVideoScreensaver.reset();
+    mNextVideoGame = nullptr;
     mGameOverlay.reset();
 
     mScreensaverActive = false;
@@ -204,7 +221,14 @@ void Screensaver::stopScreensaver()
 
 void Screensaver::nextGame()
 {
+    // Keep any prefetched video so that it can be started right away.
+    std::unique_ptr<VideoComponent> nextVideo {std::move(mNextVideoScreensaver)};
+    FileData* nextVideoGame {mNextVideoGame};
+
     stopScreensaver();
+
+    mNextVideoScreensaver = std::move(nextVideo);
+    mNextVideoGame = nextVideoGame;
     startScreensaver(false);
 }
 
@@ -397,6 +421,9 @@ void Screensaver::update(int deltaTime)
 
     if (mVideoScreensaver)
         mVideoScreensaver->update(deltaTime);
+
+    if (mNextVideoScreensaver)
+        mNextVideoScreensaver->prefetchVideoPlayer();
 }
 
 void Screensaver::generateImageList()
@@ -597,8 +624,6 @@ void Screensaver::generateVideoList()
             }
         }
     }
-
-    mFilesInventory.insert(mFilesInventory.begin(), mVideoFiles.begin(), mVideoFiles.end());
 }
 
 void Screensaver::generateCustomImageList()
@@ -677,43 +702,61 @@ void Screensaver::pickRandomImage(std::string& path)
     mImageFiles.erase(it);
 }
 
-void Screensaver::pickRandomVideo(std::string& path)
+FileData* Screensaver::pickRandomVideo()
 {
-    mCurrentGame = nullptr;
-
     if (mVideoFiles.size() == 0)
-        return;
+        return nullptr;
 
-    if (mVideoFiles.size() == 1) {
-        mPreviousGame = nullptr;
-        mCurrentGame = mVideoFiles.front();
-        path = mVideoFiles.front()->getVideoPath();
-        mGameName = mVideoFiles.front()->getName();
-        mSystemName = mVideoFiles.front()->getSystem()->getFullName();
-        mCurrentGame = mVideoFiles.front();
-        mVideoFiles.clear();
-        return;
-    }
+    if (mVideoFiles.size() == 1)
+        return mVideoFiles.front();
 
-    unsigned int index;
+    // The videos that have been played are moved to the end of mVideoFiles, and the random
+    // selection is made among the unplayed videos at the beginning of the list. This way the
+    // same video is not played again until we've cycled through all entries.
+    if (mUnplayedVideoCount == 0)
+        mUnplayedVideoCount = mVideoFiles.size();
+
+    const size_t recentVideosHistory {
+        std::min(mVideoFiles.size() / 2, static_cast<size_t>(RECENT_VIDEOS_HISTORY))};
+    std::uniform_int_distribution<size_t> uniformDist {0, mUnplayedVideoCount - 1};
+    size_t index;
+
+    // Avoid the most recently played videos when starting over from the beginning. There are
+    // always more unplayed videos than recent videos so this loop will eventually finish.
     do {
-        // Get a random number in range.
-        std::random_device randDev;
-        //  Mersenne Twister pseudorandom number generator.
-        std::mt19937 engine {randDev()};
-        std::uniform_int_distribution<int> uniform_dist {0,
-                                                         static_cast<int>(mVideoFiles.size()) - 1};
-        index = uniform_dist(engine);
-    } while (mPreviousGame && mVideoFiles.at(index) == mPreviousGame);
+        index = uniformDist(mRandomEngine);
+    } while (std::find(mRecentVideos.cbegin(), mRecentVideos.cend(), mVideoFiles[index]) !=
+             mRecentVideos.cend());
+
+    --mUnplayedVideoCount;
+    std::swap(mVideoFiles[index], mVideoFiles[mUnplayedVideoCount]);
+    FileData* game {mVideoFiles[mUnplayedVideoCount]};
+
+    mRecentVideos.emplace_back(game);
+    while (mRecentVideos.size() > recentVideosHistory)
+        mRecentVideos.pop_front();
+
+    return game;
+}
+
+std::unique_ptr<VideoComponent> Screensaver::createVideoScreensaver(const std::string& path)
+{
+    if (path.empty() || !Utils::FileSystem::exists(path))
+        return nullptr;
+
+    std::unique_ptr<VideoComponent> video {std::make_unique<VideoFFmpegComponent>()};
+    video->setOrigin(0.5f, 0.5f);
+    video->setPosition(Renderer::getScreenWidth() / 2.0f, Renderer::getScreenHeight() / 2.0f);
+
+    if (Settings::getInstance()->getBool("ScreensaverStretchVideos"))
+        video->setResize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
+    else
+        video->setMaxSize(Renderer::getScreenWidth(), Renderer::getScreenHeight());
 
-    path = mVideoFiles.at(index)->getVideoPath();
-    mGameName = mVideoFiles.at(index)->getName();
-    mSystemName = mVideoFiles.at(index)->getSystem()->getFullName();
-    mCurrentGame = mVideoFiles.at(index);
+    video->setVideo(path);
+    video->setScreensaverMode(true);
 
-    // Don't play the same video again until we've cycled through all entries.
-    auto it = mVideoFiles.begin() + index;
-    mVideoFiles.erase(it);
+    return video;
 }
 
 void Screensaver::pickRandomCustomImage(std::string& path)
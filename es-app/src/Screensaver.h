@@ -15,6 +15,9 @@
 #include "components/TextComponent.h"
 #include "components/VideoComponent.h"
 
+#include <deque>
+#include <random>
+
 class Screensaver : public Window::Screensaver
 {
 public:
@@ -40,7 +43,8 @@ private:
     void generateVideoList();
     void generateCustomImageList();
     void pickRandomImage(std::string& path);
-    void pickRandomVideo(std::string& path);
+    FileData* pickRandomVideo();
+    std::unique_ptr<VideoComponent> createVideoScreensaver(const std::string& path);
     void pickRandomCustomImage(std::string& path);
     void generateOverlayInfo();
 
@@ -54,6 +58,13 @@ private:
     std::vector<std::string> mCustomFilesInventory;
     std::unique_ptr<ImageComponent> mImageScreensaver;
     std::unique_ptr<VideoComponent> mVideoScreensaver;
+    // The next video is opened and its first frames are decoded while the current video is
+    // playing, so that there is no delay when switching to it.
+    std::unique_ptr<VideoComponent> mNextVideoScreensaver;
+    FileData* mNextVideoGame;
+    // Recently played videos, these are avoided when starting over from the beginning.
+    std::deque<FileData*> mRecentVideos;
+    std::mt19937 mRandomEngine;
     std::unique_ptr<TextComponent> mGameOverlay;
     std::vector<float> mGameOverlayRectangleCoords;
 
@@ -64,6 +75,7 @@ private:
     std::string mGameName;
     std::string mSystemName;
 
+    size_t mUnplayedVideoCount;
     int mTimer;
     int mMediaSwapTime;
     bool mScreensaverActive;
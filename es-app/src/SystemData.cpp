@@ -30,9 +30,14 @@
 #include <SDL2/SDL_events.h>
 #include <SDL2/SDL_timer.h>
 
+#include <atomic>
 #include <fstream>
 #include <pugixml.hpp>
 #include <random>
+#include <thread>
+
+// Upper limit for the number of threads used for loading the system themes.
+#define MAX_THEME_LOADING_THREADS 8
 
 FindRules::FindRules()
 {
@@ -1590,6 +1595,12 @@ std::pair<unsigned int, unsigned int> SystemData::getDisplayedGameCount() const
 }
 
 void SystemData::loadTheme(ThemeTriggers::TriggerType trigger)
+{
+    loadThemeFile(trigger);
+    ThemeData::setVariantDefinedTransitions(mTheme->getDefinedTransitions());
+}
+
+void SystemData::loadThemeFile(ThemeTriggers::TriggerType trigger)
 {
     mTheme = std::make_shared<ThemeData>();
 
@@ -1694,6 +1705,54 @@ void SystemData::loadTheme(ThemeTriggers::TriggerType trigger)
     }
 }
 
+void SystemData::loadThemes(const std::vector<SystemData*>& systems)
+{
+    // The themes are loaded on their own until a theme file has been found, as this sets the
+    // static theme selections such as the aspect ratio and language, which are then only read
+    // when loading the other themes.
+    size_t firstParallelSystem {0};
+    while (firstParallelSystem < systems.size()) {
+        SystemData* system {systems[firstParallelSystem++]};
+        system->loadThemeFile(ThemeTriggers::TriggerType::NONE);
+        if (Utils::FileSystem::exists(system->getThemePath()))
+            break;
+    }
+
+    if (firstParallelSystem < systems.size())
+        loadThemesParallel(systems, firstParallelSystem);
+
+    // Same result as when loading the themes sequentially, i.e. as set by the last system.
+    if (!systems.empty())
+        ThemeData::setVariantDefinedTransitions(systems.back()->mTheme->getDefinedTransitions());
+}
+
+void SystemData::loadThemesParallel(const std::vector<SystemData*>& systems,
+                                    const size_t firstParallelSystem)
+{
+    // Theme loading only involves parsing the theme files, the fonts and textures are loaded
+    // on the main thread when the views are populated.
+    std::atomic<size_t> nextSystem {firstParallelSystem};
+    auto loadFunction = [&systems, &nextSystem]() {
+        for (size_t i {nextSystem++}; i < systems.size(); i = nextSystem++)
+            systems[i]->loadThemeFile(ThemeTriggers::TriggerType::NONE);
+    };
+
+    const size_t threadCount {std::min(
+        systems.size() - firstParallelSystem,
+        static_cast<size_t>(std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1,
+                                        MAX_THEME_LOADING_THREADS)))};
+
+    std::vector<std::thread> loadThreads;
+    // The calling thread takes part in the loading as well.
+    for (size_t i {1}; i < threadCount; ++i)
+        loadThreads.emplace_back(loadFunction);
+
+    loadFunction();
+
+    for (auto& thread : loadThreads)
+        thread.join();
+}
+
 void SystemData::writeMetaData()
 {
     if (Settings::getInstance()->getBool("IgnoreGamelist") || mIsCollectionSystem)
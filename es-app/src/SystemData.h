@@ -142,6 +142,8 @@ public:
 
     // Load or reload theme.
     void loadTheme(ThemeTriggers::TriggerType trigger);
+    // Load or reload the themes for multiple systems in parallel.
+    static void loadThemes(const std::vector<SystemData*>& systems);
 
     FileFilterIndex* getIndex() { return mFilterIndex; }
     void onMetaDataSavePoint();
@@ -170,6 +172,11 @@ private:
     void indexAllGameFilters(const FileData* folder);
     void setIsGameSystemStatus();
 
+    // Loads the theme without updating the variant-defined transitions.
+    void loadThemeFile(ThemeTriggers::TriggerType trigger);
+    static void loadThemesParallel(const std::vector<SystemData*>& systems,
+                                   const size_t firstParallelSystem);
+
     FileFilterIndex* mFilterIndex;
 
     FileData* mRootFolder;
@@ -15,6 +15,7 @@
 #endif
 
 #include "ApplicationVersion.h"
+#include "AudioManager.h"
 #include "CollectionSystemsManager.h"
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
@@ -1248,6 +1249,7 @@ void GuiMenu::openSoundOptions()
             static_cast<float>(Settings::getInstance()->getInt("SoundVolumeNavigation"))) {
             Settings::getInstance()->setInt("SoundVolumeNavigation",
                                             static_cast<int>(soundVolumeNavigation->getValue()));
+            AudioManager::getInstance().updateVolumes();
             s->setNeedsSaving();
         }
     });
@@ -1262,6 +1264,7 @@ void GuiMenu::openSoundOptions()
             static_cast<float>(Settings::getInstance()->getInt("SoundVolumeVideos"))) {
             Settings::getInstance()->setInt("SoundVolumeVideos",
                                             static_cast<int>(soundVolumeVideos->getValue()));
+            AudioManager::getInstance().updateVolumes();
             s->setNeedsSaving();
         }
     });
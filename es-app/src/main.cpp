@@ -16,6 +16,7 @@
 #include "ApplicationVersion.h"
 #include "AudioManager.h"
 #include "CollectionSystemsManager.h"
+#include "FrameStatistics.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "MameNames.h"
@@ -552,10 +553,15 @@ void applicationLoop()
             }
         }
 #endif
+        FrameStatistics& frameStatistics {FrameStatistics::getInstance()};
+        frameStatistics.beginSection(FrameStatistics::Section::UPDATE);
         window->update(deltaTime);
+        frameStatistics.beginSection(FrameStatistics::Section::RENDER);
         window->render();
 
+        frameStatistics.beginSection(FrameStatistics::Section::SWAP);
         renderer->swapBuffers();
+        frameStatistics.endFrame();
         Log::flush();
 #if !defined(__EMSCRIPTEN__)
     }
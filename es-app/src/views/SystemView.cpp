@@ -284,6 +284,13 @@ void SystemView::onCursorChanged(const CursorState& state)
         }
     }
 
+    // Start loading the gamelist theme images before the system is entered, and drop them
+    // again as soon as the cursor moves.
+    if (state == CursorState::CURSOR_STOPPED)
+        ViewController::getInstance()->preloadGamelistAssets(mPrimary->getSelected());
+    else
+        ViewController::getInstance()->releasePreloadedGamelistAssets();
+
     // Avoid double updates.
     if (cursor != mLastCursor) {
         for (auto& selector : mSystemElements[cursor].gameSelectors) {
@@ -32,6 +32,9 @@
 #include "guis/GuiMenu.h"
 #include "guis/GuiTextEditKeyboardPopup.h"
 #include "guis/GuiTextEditPopup.h"
+#include "resources/TextureData.h"
+#include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
 #include "utils/LocalizationUtil.h"
 #include "views/GamelistView.h"
 #include "views/SystemView.h"
@@ -47,6 +50,7 @@ ViewController::ViewController() noexcept
     , mPreviousView {nullptr}
     , mSkipView {nullptr}
     , mLastTransitionAnim {ViewTransitionAnimation::INSTANT}
+    , mPreloadedGamelistSystem {nullptr}
     , mGameToLaunch {nullptr}
     , mCamera {Renderer::getIdentity()}
     , mSystemViewTransition {false}
@@ -746,6 +750,38 @@ void ViewController::goToPrevGamelist()
     goToGamelist(system->getPrev());
 }
 
+void ViewController::preloadGamelistAssets(SystemData* system)
+{
+    if (system == mPreloadedGamelistSystem)
+        return;
+
+    releasePreloadedGamelistAssets();
+
+    if (system == nullptr || system->getTheme() == nullptr)
+        return;
+
+    mPreloadedGamelistSystem = system;
+
+    // The textures are created with the same flags as used by ImageComponent, so they will be
+    // shared with the gamelist view when it's populated. SVG images are skipped as these are
+    // rasterized at the element size which is not known until the view is created.
+    for (auto& image : system->getTheme()->getAssetManifest("gamelist").images) {
+        if (Utils::String::toLower(Utils::FileSystem::getExtension(image.path)) == ".svg")
+            continue;
+        // Never evict any textures used by the system view that is currently displayed.
+        if (!TextureResource::hasPreloadHeadroom())
+            break;
+        mPreloadedGamelistTextures.emplace_back(
+            TextureResource::get(image.path, image.tile, false, true, image.linearMagnify));
+    }
+}
+
+void ViewController::releasePreloadedGamelistAssets()
+{
+    mPreloadedGamelistSystem = nullptr;
+    mPreloadedGamelistTextures.clear();
+}
+
 void ViewController::goToGamelist(SystemData* system)
 {
     bool wrapFirstToLast {false};
@@ -887,6 +923,9 @@ void ViewController::goToGamelist(SystemData* system)
     mCurrentView = getGamelistView(system);
     mCurrentView->finishAnimation(0);
 
+    // The gamelist view now holds its own references to the preloaded textures.
+    releasePreloadedGamelistAssets();
+
     // Application startup animation, if starting in a gamelist rather than in the system view.
     if (mState.viewing == ViewMode::NOTHING) {
         if (mLastTransitionAnim == ViewTransitionAnimation::FADE)
@@ -1435,6 +1474,8 @@ void ViewController::preload()
     // Short delay so that the full progress bar is always visible before proceeding.
     SDL_Delay(100);
 
+    ThemeData::clearParsedFileCache();
+
     if (SystemData::sSystemVector.size() > 0)
         ThemeData::setThemeTransitions();
 
@@ -1517,6 +1558,12 @@ void ViewController::reloadAll()
 
     cancelViewTransitions();
 
+    // Any symlinks to the media files may have been changed since the paths were resolved,
+    // and the theme SVG files may have been modified.
+    Utils::FileSystem::clearCanonicalPathCache();
+    TextureData::clearRasterCache();
+    releasePreloadedGamelistAssets();
+
     // Clear all GamelistViews.
     std::map<SystemData*, FileData*> cursorMap;
     for (auto it = mGamelistViews.cbegin(); it != mGamelistViews.cend(); ++it) {
@@ -1529,11 +1576,16 @@ void ViewController::reloadAll()
     mCurrentView = nullptr;
 
     // Load themes, create GamelistViews and reset filters.
-    for (auto it = cursorMap.cbegin(); it != cursorMap.cend(); ++it) {
-        it->first->loadTheme(ThemeTriggers::TriggerType::NONE);
+    std::vector<SystemData*> systems;
+    for (auto it = cursorMap.cbegin(); it != cursorMap.cend(); ++it)
+        systems.emplace_back(it->first);
+
+    SystemData::loadThemes(systems);
+
+    for (auto it = cursorMap.cbegin(); it != cursorMap.cend(); ++it)
         it->first->getIndex()->resetFilters();
-    }
 
+    ThemeData::clearParsedFileCache();
     ThemeData::setThemeTransitions();
 
     // Rebuild SystemListView.
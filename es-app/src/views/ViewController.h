@@ -17,6 +17,7 @@
 #include "GuiComponent.h"
 #include "guis/GuiMsgBox.h"
 #include "renderers/Renderer.h"
+#include "resources/TextureResource.h"
 #include "utils/StringUtil.h"
 
 #include <vector>
@@ -45,6 +46,11 @@ public:
     // Try to completely populate the GamelistView map.
     // Caches things so there's no pauses during transitions.
     void preload();
+    // Loads the theme images of the gamelist view for the system in the background, this is
+    // done when the system is selected in the system view to avoid pop-in during the transition.
+    // The textures are kept until released or until the gamelist view has been entered.
+    void preloadGamelistAssets(SystemData* system);
+    void releasePreloadedGamelistAssets();
 
     // If a basic view detected a metadata change, it can request to recreate
     // the current gamelist view (as it may change to be detailed).
@@ -193,6 +199,9 @@ private:
     std::shared_ptr<SystemView> mSystemListView;
     ViewTransitionAnimation mLastTransitionAnim;
 
+    SystemData* mPreloadedGamelistSystem;
+    std::vector<std::shared_ptr<TextureResource>> mPreloadedGamelistTextures;
+
     FileData* mGameToLaunch;
     State mState;
 
@@ -14,6 +14,13 @@
 
 #include <SDL2/SDL.h>
 
+#include <algorithm>
+#include <cstring>
+
+// Size in bytes of the ring buffer for the video stream audio, this must be a power of two.
+// At 48 kHz with two 32-bit floating point channels this covers around 1.4 seconds.
+#define STREAM_BUFFER_SIZE 524288
+
 AudioManager::AudioManager() noexcept
 {
     // Init on construction.
@@ -36,6 +43,10 @@ void AudioManager::init()
 {
     LOG(LogInfo) << "Setting up AudioManager...";
 
+    // Allocated up front so the audio callback never has to allocate anything.
+    if (sStreamBuffer.empty())
+        sStreamBuffer.resize(STREAM_BUFFER_SIZE);
+
 #if defined(__ANDROID__)
     if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
         if (Settings::getInstance()->getString("AudioDriver") != "AAudio") {
@@ -126,6 +137,7 @@ void AudioManager::init()
     if (Settings::getInstance()->getInt("SoundVolumeVideos") < 0)
         Settings::getInstance()->setInt("SoundVolumeVideos", 0);
 
+    updateVolumes();
     setupAudioStream(sRequestedAudioFormat.freq);
 }
 
@@ -147,16 +159,18 @@ void AudioManager::deinit()
 
 void AudioManager::mixAudio(void* /*unused*/, Uint8* stream, int len)
 {
+    // This is the SDL audio callback, so there must be no allocations, locking or settings
+    // lookups in here or there may be audio dropouts when the system is under load.
+
     // Process navigation sounds.
     bool stillPlaying {false};
+    const int navigationVolume {sNavigationMixVolume};
 
     // Initialize the buffer to "silence".
     SDL_memset(stream, 0, len);
 
     // Iterate through all our samples.
-    std::vector<std::shared_ptr<Sound>>::const_iterator soundIt {sSoundVector.cbegin()};
-    while (soundIt != sSoundVector.cend()) {
-        std::shared_ptr<Sound> sound {*soundIt};
+    for (Sound* sound : sMixSounds) {
         if (sound->isPlaying()) {
             // Calculate rest length of current sample.
             Uint32 restLength {sound->getLength() - sound->getPosition()};
@@ -165,9 +179,8 @@ void AudioManager::mixAudio(void* /*unused*/, Uint8* stream, int len)
                 restLength = len;
             }
             // Mix sample into stream.
-            SDL_MixAudioFormat(
-                stream, &(sound->getData()[sound->getPosition()]), sAudioFormat.format, restLength,
-                static_cast<int>(Settings::getInstance()->getInt("SoundVolumeNavigation") * 1.28f));
+            SDL_MixAudioFormat(stream, &(sound->getData()[sound->getPosition()]),
+                               sAudioFormat.format, restLength, navigationVolume);
             if (sound->getPosition() + restLength < sound->getLength()) {
                 // Sample hasn't ended yet.
                 stillPlaying = true;
@@ -176,60 +189,51 @@ void AudioManager::mixAudio(void* /*unused*/, Uint8* stream, int len)
             // it will stop automatically.
             sound->setPosition(sound->getPosition() + restLength);
         }
-        // Advance to next sound.
-        ++soundIt;
     }
 
     // Process video stream audio generated by VideoFFmpegComponent.
-    int streamLength {SDL_AudioStreamAvailable(sConversionStream)};
+    const size_t readPosition {sStreamReadPosition.load(std::memory_order_relaxed)};
+    const size_t writePosition {sStreamWritePosition.load(std::memory_order_acquire)};
+    const size_t streamLength {writePosition - readPosition};
 
-    if (streamLength <= 0) {
+    if (streamLength == 0) {
         // If nothing is playing, pause the device until there is more audio to output.
         if (!stillPlaying)
             SDL_PauseAudioDevice(sAudioDevice, 1);
         return;
     }
 
-    int chunkLength {0};
-
     // Cap the chunk length to the buffer size.
-    if (streamLength > len)
-        chunkLength = len;
-    else
-        chunkLength = streamLength;
-
-    std::vector<Uint8> converted(chunkLength);
-
-    int processedLength {
-        SDL_AudioStreamGet(sConversionStream, static_cast<void*>(&converted.at(0)), chunkLength)};
-
-    if (processedLength < 0) {
-        LOG(LogError) << "AudioManager::mixAudio(): Couldn't convert sound chunk:";
-        LOG(LogError) << SDL_GetError();
-        return;
-    }
+    const size_t chunkLength {std::min(streamLength, static_cast<size_t>(len))};
 
     // Enable only when needed, as this generates a lot of debug output.
-    //    LOG(LogDebug) << "AudioManager::mixAudio(): chunkLength "
-    //            "/ processedLength / streamLength: " << chunkLength << " / " <<
-    //            " / " << processedLength << " / " << streamLength;
+    //    LOG(LogDebug) << "AudioManager::mixAudio(): chunkLength / streamLength: "
+    //                  << chunkLength << " / " << streamLength;
 
     // This mute flag is used to make sure that the audio buffer already sent to the
     // stream is not played when the video player has been stopped. Otherwise there would
     // be a short time period when the audio would keep playing after the video was stopped
     // and before the stream was cleared in clearStream().
-    bool muteStream {sMuteStream};
-    if (muteStream) {
-        SDL_MixAudioFormat(stream, &converted.at(0), sAudioFormat.format, processedLength, 0);
-    }
-    else {
-        SDL_MixAudioFormat(
-            stream, &converted.at(0), sAudioFormat.format, processedLength,
-            static_cast<int>(Settings::getInstance()->getInt("SoundVolumeVideos") * 1.28f));
+    if (!sMuteStream) {
+        // The chunk may wrap around the end of the ring buffer, in which case it's mixed in
+        // two parts. As the buffer size is a power of two the split is always on a sample
+        // boundary.
+        const int videoVolume {sVideoMixVolume};
+        const size_t offset {readPosition & (STREAM_BUFFER_SIZE - 1)};
+        const size_t firstLength {std::min(chunkLength, STREAM_BUFFER_SIZE - offset)};
+
+        SDL_MixAudioFormat(stream, &sStreamBuffer[offset], sAudioFormat.format,
+                           static_cast<Uint32>(firstLength), videoVolume);
+        if (firstLength < chunkLength) {
+            SDL_MixAudioFormat(stream + firstLength, &sStreamBuffer[0], sAudioFormat.format,
+                               static_cast<Uint32>(chunkLength - firstLength), videoVolume);
+        }
     }
 
+    sStreamReadPosition.store(readPosition + chunkLength, std::memory_order_release);
+
     // If nothing is playing, pause the device until there is more audio to output.
-    if (!stillPlaying && SDL_AudioStreamAvailable(sConversionStream) == 0)
+    if (!stillPlaying && chunkLength == streamLength)
         SDL_PauseAudioDevice(sAudioDevice, 1);
 }
 
@@ -237,6 +241,7 @@ void AudioManager::registerSound(std::shared_ptr<Sound> sound)
 {
     // Add sound to sound vector.
     sSoundVector.push_back(sound);
+    updateMixSounds();
 }
 
 void AudioManager::unregisterSound(std::shared_ptr<Sound> sound)
@@ -245,11 +250,35 @@ void AudioManager::unregisterSound(std::shared_ptr<Sound> sound)
         if (sSoundVector.at(i) == sound) {
             sSoundVector[i]->stop();
             sSoundVector.erase(sSoundVector.cbegin() + i);
+            // The sound parameter keeps the object alive until the callback no longer uses it.
+            updateMixSounds();
             return;
         }
     }
 }
 
+void AudioManager::updateMixSounds()
+{
+    std::vector<Sound*> mixSounds;
+    mixSounds.reserve(sSoundVector.size());
+
+    for (auto& sound : sSoundVector)
+        mixSounds.emplace_back(sound.get());
+
+    // Swap while locked, the previous list is then freed outside the audio callback.
+    SDL_LockAudioDevice(sAudioDevice);
+    sMixSounds.swap(mixSounds);
+    SDL_UnlockAudioDevice(sAudioDevice);
+}
+
+void AudioManager::updateVolumes()
+{
+    sNavigationMixVolume =
+        static_cast<int>(Settings::getInstance()->getInt("SoundVolumeNavigation") * 1.28f);
+    sVideoMixVolume =
+        static_cast<int>(Settings::getInstance()->getInt("SoundVolumeVideos") * 1.28f);
+}
+
 void AudioManager::play()
 {
     // Unpause audio, the mixer will figure out if samples need to be played...
@@ -284,6 +313,9 @@ void AudioManager::setupAudioStream(int sampleRate)
         LOG(LogError) << SDL_GetError();
     }
 
+    // Discard any audio in the stream buffer as it may be in an outdated format.
+    discardStreamBuffer();
+
     // If the device was previously in a playing state, then restore it.
     if (audioStatus == SDL_AUDIO_PLAYING)
         SDL_PauseAudioDevice(sAudioDevice, 0);
@@ -291,24 +323,74 @@ void AudioManager::setupAudioStream(int sampleRate)
 
 void AudioManager::processStream(const void* samples, unsigned count)
 {
-    SDL_LockAudioDevice(sAudioDevice);
+    if (sConversionStream == nullptr || sStreamBuffer.empty())
+        return;
 
     if (SDL_AudioStreamPut(sConversionStream, samples, count * sizeof(Uint8)) == -1) {
         LOG(LogError) << "Failed to put samples in the conversion stream:";
         LOG(LogError) << SDL_GetError();
-        SDL_UnlockAudioDevice(sAudioDevice);
         return;
     }
 
+    const size_t writePosition {sStreamWritePosition.load(std::memory_order_relaxed)};
+    const size_t readPosition {sStreamReadPosition.load(std::memory_order_acquire)};
+    const int frameSize {SDL_AUDIO_BITSIZE(sAudioFormat.format) / 8 * sAudioFormat.channels};
+
+    // Only whole sample frames can be retrieved from the conversion stream, any audio that
+    // does not fit in the ring buffer is kept in the conversion stream until the next call.
+    int length {std::min(SDL_AudioStreamAvailable(sConversionStream),
+                         static_cast<int>(STREAM_BUFFER_SIZE - (writePosition - readPosition)))};
+    length -= length % frameSize;
+
+    if (length > 0) {
+        if (sConvertedAudio.size() < static_cast<size_t>(length))
+            sConvertedAudio.resize(length);
+
+        const int processedLength {
+            SDL_AudioStreamGet(sConversionStream, &sConvertedAudio[0], length)};
+
+        if (processedLength < 0) {
+            LOG(LogError) << "AudioManager::processStream(): Couldn't convert sound chunk:";
+            LOG(LogError) << SDL_GetError();
+            return;
+        }
+
+        const size_t offset {writePosition & (STREAM_BUFFER_SIZE - 1)};
+        const size_t firstLength {
+            std::min(static_cast<size_t>(processedLength), STREAM_BUFFER_SIZE - offset)};
+
+        std::memcpy(&sStreamBuffer[offset], &sConvertedAudio[0], firstLength);
+        if (firstLength < static_cast<size_t>(processedLength)) {
+            std::memcpy(&sStreamBuffer[0], &sConvertedAudio[firstLength],
+                        processedLength - firstLength);
+        }
+
+        sStreamWritePosition.store(writePosition + processedLength, std::memory_order_release);
+    }
+
     if (count > 0)
         SDL_PauseAudioDevice(sAudioDevice, 0);
-
-    SDL_UnlockAudioDevice(sAudioDevice);
 }
 
 void AudioManager::clearStream()
 {
-    SDL_LockAudioDevice(sAudioDevice);
-    SDL_AudioStreamClear(sConversionStream);
-    SDL_UnlockAudioDevice(sAudioDevice);
+    if (sConversionStream != nullptr)
+        SDL_AudioStreamClear(sConversionStream);
+
+    discardStreamBuffer();
+}
+
+void AudioManager::discardStreamBuffer()
+{
+    // The read position is otherwise only written by the audio callback, so the device needs
+    // to be locked to make sure the callback is not in the middle of mixing a chunk that would
+    // then overwrite the reset position.
+    if (sAudioDevice != 0)
+        SDL_LockAudioDevice(sAudioDevice);
+
+    sStreamReadPosition.store(sStreamWritePosition.load(std::memory_order_relaxed),
+                              std::memory_order_release);
+
+    if (sAudioDevice != 0)
+        SDL_UnlockAudioDevice(sAudioDevice);
 }
@@ -39,6 +39,10 @@ public:
     void muteStream() { sMuteStream = true; }
     void unmuteStream() { sMuteStream = false; }
 
+    // Caches the volume settings for use by the audio callback, this needs to be called
+    // whenever the SoundVolumeNavigation or SoundVolumeVideos settings have been changed.
+    void updateVolumes();
+
     bool getHasAudioDevice() { return sHasAudioDevice; }
 
     static inline SDL_AudioDeviceID sAudioDevice {0};
@@ -48,9 +52,27 @@ private:
     AudioManager() noexcept;
 
     static void mixAudio(void* unused, Uint8* stream, int len);
+    static void discardStreamBuffer();
+    void updateMixSounds();
 
+    // Only accessed by processStream(), i.e. the producer side of the stream buffer.
     static inline SDL_AudioStream* sConversionStream {nullptr};
+    static inline std::vector<Uint8> sConvertedAudio;
+
+    // Single-producer/single-consumer ring buffer for the converted video stream audio, filled
+    // by processStream() and emptied by the audio callback without any locking. The positions
+    // are increasing byte counts, only discardStreamBuffer() locks the device to reset them.
+    static inline std::vector<Uint8> sStreamBuffer;
+    static inline std::atomic<size_t> sStreamReadPosition {0};
+    static inline std::atomic<size_t> sStreamWritePosition {0};
+
     static inline std::vector<std::shared_ptr<Sound>> sSoundVector;
+    // The registered sounds as raw pointers for the audio callback, only replaced while the
+    // audio device is locked so the callback never has to copy any shared pointers.
+    static inline std::vector<Sound*> sMixSounds;
+
+    static inline std::atomic<int> sNavigationMixVolume {0};
+    static inline std::atomic<int> sVideoMixVolume {0};
     static inline std::atomic<bool> sMuteStream {false};
     static inline bool sHasAudioDevice {true};
 };
@@ -0,0 +1,200 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  FrameStatistics.cpp
+//
+//  Frame time statistics, used for the GPU statistics overlay and optionally logged
+//  to a CSV file to make it possible to diagnose stuttering.
+//  This class is not thread safe.
+//
+
+#include "FrameStatistics.h"
+
+#include "Log.h"
+#include "Settings.h"
+#include "renderers/Renderer.h"
+#include "resources/TextureResource.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+// Number of frames used for the percentiles and the histogram, at 60 FPS this covers
+// the last 10 seconds.
+#define FRAME_HISTORY_SIZE 600
+
+FrameStatistics::FrameStatistics()
+    : mFrames(FRAME_HISTORY_SIZE)
+    , mFramePosition {0}
+    , mFrameCount {0}
+    , mTotalFrameCount {0}
+    , mCurrentFrame {}
+    , mCurrentSection {Section::UPDATE}
+    , mSectionActive {false}
+    , mSectionStartTime {clock::now()}
+    , mLastFrameTime {clock::now()}
+    , mCSVStartTime {clock::now()}
+{
+}
+
+FrameStatistics::~FrameStatistics()
+{
+    if (mCSVFile.is_open())
+        mCSVFile.close();
+}
+
+FrameStatistics& FrameStatistics::getInstance()
+{
+    static FrameStatistics instance;
+    return instance;
+}
+
+void FrameStatistics::beginSection(const Section section)
+{
+    const clock::time_point currentTime {clock::now()};
+
+    if (mSectionActive) {
+        mCurrentFrame.sectionTimes[static_cast<size_t>(mCurrentSection)] +=
+            std::chrono::duration<float, std::milli>(currentTime - mSectionStartTime).count();
+    }
+
+    mCurrentSection = section;
+    mSectionActive = true;
+    mSectionStartTime = currentTime;
+}
+
+void FrameStatistics::endFrame()
+{
+    const clock::time_point currentTime {clock::now()};
+
+    if (mSectionActive) {
+        mCurrentFrame.sectionTimes[static_cast<size_t>(mCurrentSection)] +=
+            std::chrono::duration<float, std::milli>(currentTime - mSectionStartTime).count();
+        mSectionActive = false;
+    }
+
+    // The frame time is the time between two consecutive frames and therefore includes
+    // event processing and anything else taking place outside the timed sections.
+    mCurrentFrame.frameTime =
+        std::chrono::duration<float, std::milli>(currentTime - mLastFrameTime).count();
+    mLastFrameTime = currentTime;
+
+    Renderer* renderer {Renderer::getInstance()};
+    const Renderer::RenderStatistics& renderStatistics {renderer->getRenderStatistics()};
+    mCurrentFrame.drawCalls = renderStatistics.drawCalls;
+    mCurrentFrame.textureUploads = renderStatistics.textureUploads;
+    mCurrentFrame.textureUploadBytes = renderStatistics.textureUploadBytes;
+    mCurrentFrame.loaderQueueSize = TextureResource::getLoaderQueueSize();
+    renderer->resetRenderStatistics();
+
+    mFrames[mFramePosition] = mCurrentFrame;
+    mFramePosition = (mFramePosition + 1) % mFrames.size();
+    mFrameCount = std::min(mFrameCount + 1, mFrames.size());
+    ++mTotalFrameCount;
+
+    if (Settings::getInstance()->getBool("FrameStatisticsLog"))
+        writeCSVEntry(mCurrentFrame);
+    else if (mCSVFile.is_open())
+        mCSVFile.close();
+
+    mCurrentFrame = {};
+}
+
+const FrameStatistics::Summary FrameStatistics::getSummary() const
+{
+    Summary summary {};
+    summary.frameCount = mFrameCount;
+    summary.histogram.resize(getHistogramBuckets().size() + 1, 0);
+
+    if (mFrameCount == 0)
+        return summary;
+
+    std::vector<float> frameTimes;
+    frameTimes.reserve(mFrameCount);
+
+    for (size_t i {0}; i < mFrameCount; ++i) {
+        const Frame& frame {mFrames[i]};
+        frameTimes.emplace_back(frame.frameTime);
+
+        for (size_t j {0}; j < frame.sectionTimes.size(); ++j)
+            summary.averageSectionTimes[j] += frame.sectionTimes[j];
+
+        summary.averageDrawCalls += static_cast<float>(frame.drawCalls);
+        summary.averageTextureUploads += static_cast<float>(frame.textureUploads);
+
+        const std::vector<float>& buckets {getHistogramBuckets()};
+        const size_t bucket {static_cast<size_t>(
+            std::upper_bound(buckets.cbegin(), buckets.cend(), frame.frameTime) -
+            buckets.cbegin())};
+        ++summary.histogram[bucket];
+    }
+
+    const float frameCount {static_cast<float>(mFrameCount)};
+    for (auto& sectionTime : summary.averageSectionTimes)
+        sectionTime /= frameCount;
+    summary.averageDrawCalls /= frameCount;
+    summary.averageTextureUploads /= frameCount;
+
+    // The most recent frame.
+    summary.loaderQueueSize =
+        mFrames[(mFramePosition + mFrames.size() - 1) % mFrames.size()].loaderQueueSize;
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&frameTimes](const float value) {
+        const size_t index {static_cast<size_t>(
+            std::ceil(value * static_cast<float>(frameTimes.size())) - 1.0f)};
+        return frameTimes[std::min(index, frameTimes.size() - 1)];
+    };
+
+    summary.p50 = percentile(0.50f);
+    summary.p95 = percentile(0.95f);
+    summary.p99 = percentile(0.99f);
+    summary.worstFrame = frameTimes.back();
+
+    return summary;
+}
+
+const std::vector<float>& FrameStatistics::getHistogramBuckets()
+{
+    // Roughly corresponding to 120, 60, 30, 20 and 10 FPS.
+    static const std::vector<float> buckets {8.4f, 16.8f, 33.4f, 50.0f, 100.0f};
+    return buckets;
+}
+
+void FrameStatistics::writeCSVEntry(const Frame& frame)
+{
+    if (!mCSVFile.is_open()) {
+        std::string csvPath {Utils::FileSystem::getAppDataDirectory()};
+        if (Settings::getInstance()->getBool("LegacyAppDataDirectory"))
+            csvPath.append("/es_frame_statistics.csv");
+        else
+            csvPath.append("/logs/es_frame_statistics.csv");
+
+#if defined(_WIN64)
+        mCSVFile.open(Utils::String::stringToWideString(csvPath).c_str(), std::ios::out);
+#else
+        mCSVFile.open(csvPath.c_str(), std::ios::out);
+#endif
+        if (!mCSVFile.is_open()) {
+            LOG(LogError) << "Couldn't open frame statistics file \"" << csvPath << "\"";
+            Settings::getInstance()->setBool("FrameStatisticsLog", false);
+            return;
+        }
+
+        LOG(LogInfo) << "Logging frame statistics to \"" << csvPath << "\"";
+        mCSVStartTime = clock::now();
+        mCSVFile << "frame,time_ms,frame_ms,update_ms,render_ms,swap_ms,draw_calls,"
+                    "texture_uploads,texture_upload_bytes,loader_queue_size\n";
+    }
+
+    mCSVFile << mTotalFrameCount << "," << std::fixed << std::setprecision(3)
+             << std::chrono::duration<double, std::milli>(clock::now() - mCSVStartTime).count()
+             << "," << frame.frameTime << ","
+             << frame.sectionTimes[static_cast<size_t>(Section::UPDATE)] << ","
+             << frame.sectionTimes[static_cast<size_t>(Section::RENDER)] << ","
+             << frame.sectionTimes[static_cast<size_t>(Section::SWAP)] << "," << frame.drawCalls
+             << "," << frame.textureUploads << "," << frame.textureUploadBytes << ","
+             << frame.loaderQueueSize << "\n";
+}
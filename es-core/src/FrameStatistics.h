@@ -0,0 +1,87 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  FrameStatistics.h
+//
+//  Frame time statistics, used for the GPU statistics overlay and optionally logged
+//  to a CSV file to make it possible to diagnose stuttering.
+//  This class is not thread safe.
+//
+
+#ifndef ES_CORE_FRAME_STATISTICS_H
+#define ES_CORE_FRAME_STATISTICS_H
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class FrameStatistics
+{
+public:
+    static FrameStatistics& getInstance();
+
+    enum class Section {
+        UPDATE,
+        RENDER,
+        SWAP,
+        COUNT // Must be last.
+    };
+
+    struct Frame {
+        float frameTime;
+        std::array<float, static_cast<size_t>(Section::COUNT)> sectionTimes;
+        unsigned int drawCalls;
+        unsigned int textureUploads;
+        size_t textureUploadBytes;
+        size_t loaderQueueSize;
+    };
+
+    struct Summary {
+        size_t frameCount;
+        float p50;
+        float p95;
+        float p99;
+        float worstFrame;
+        std::array<float, static_cast<size_t>(Section::COUNT)> averageSectionTimes;
+        float averageDrawCalls;
+        float averageTextureUploads;
+        size_t loaderQueueSize;
+        std::vector<size_t> histogram;
+    };
+
+    // Ends the previous section (if any) and starts timing the next one.
+    void beginSection(const Section section);
+    // Ends the last section and records the frame, this is to be called after swapping buffers.
+    void endFrame();
+
+    // Summary of the recorded frame history.
+    const Summary getSummary() const;
+    // Upper bounds in milliseconds of all histogram buckets except the last one.
+    static const std::vector<float>& getHistogramBuckets();
+
+private:
+    FrameStatistics();
+    ~FrameStatistics();
+
+    void writeCSVEntry(const Frame& frame);
+
+    using clock = std::chrono::steady_clock;
+
+    std::vector<Frame> mFrames;
+    size_t mFramePosition;
+    size_t mFrameCount;
+    unsigned long mTotalFrameCount;
+
+    Frame mCurrentFrame;
+    Section mCurrentSection;
+    bool mSectionActive;
+    clock::time_point mSectionStartTime;
+    clock::time_point mLastFrameTime;
+
+    std::ofstream mCSVFile;
+    clock::time_point mCSVStartTime;
+};
+
+#endif // ES_CORE_FRAME_STATISTICS_H
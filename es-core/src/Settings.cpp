@@ -348,7 +348,10 @@ void Settings::setDefaults()
     mBoolMap["DebugSkipInputLogging"] = {false, false};
     mBoolMap["DebugSkipMissingThemeFiles"] = {false, false};
     mBoolMap["DebugSkipMissingThemeFilesCustomCollections"] = {true, true};
+    mBoolMap["FontSignedDistanceField"] = {false, false};
+    mBoolMap["FrameStatisticsLog"] = {false, false};
     mBoolMap["LegacyGamelistFileLocation"] = {false, false};
+    mBoolMap["VideoGPUColorConversion"] = {false, false};
     mBoolMap["CreatePlaceholderSystemDirectories"] = {false, false};
     mStringMap["OpenGLVersion"] = {"", ""};
 #if !defined(__ANDROID__)
@@ -362,6 +365,7 @@ void Settings::setDefaults()
     mIntMap["LottieMaxTotalCache"] = {1024, 1024};
     mIntMap["ScraperConnectionTimeout"] = {30, 30};
     mIntMap["ScraperTransferTimeout"] = {120, 120};
+    mIntMap["VideoThreadBudget"] = {0, 0};
 
     //
     // Hardcoded or program-internal settings.
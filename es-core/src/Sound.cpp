@@ -14,16 +14,21 @@
 #include "Settings.h"
 #include "ThemeData.h"
 #include "resources/ResourceManager.h"
+#include "utils/FileSystemUtil.h"
 
 std::shared_ptr<Sound> Sound::get(const std::string& path)
 {
-    auto it = sMap.find(path);
+    std::string canonicalPath {Utils::FileSystem::getCachedCanonicalPath(path)};
+    if (canonicalPath.empty())
+        canonicalPath = path;
+
+    auto it = sMap.find(canonicalPath);
     if (it != sMap.cend())
         return it->second;
 
-    std::shared_ptr<Sound> sound {std::shared_ptr<Sound>(new Sound(path))};
+    std::shared_ptr<Sound> sound {std::shared_ptr<Sound>(new Sound(canonicalPath))};
     AudioManager::getInstance().registerSound(sound);
-    sMap[path] = sound;
+    sMap[canonicalPath] = sound;
     return sound;
 }
 
@@ -80,49 +85,67 @@ void Sound::init()
     if (mPath.empty())
         return;
 
-    // Load WAV file via SDL.
-    SDL_AudioSpec wave;
-    Uint8* data {nullptr};
-    Uint32 dlen {0};
-    if (SDL_LoadWAV(mPath.c_str(), &wave, &data, &dlen) == nullptr) {
-        LOG(LogError) << "Failed to load theme navigation sound file: " << SDL_GetError();
-        return;
-    }
-
-    // Convert sound file to the format required by ES-DE.
-    SDL_AudioStream* conversionStream {
-        SDL_NewAudioStream(wave.format, wave.channels, wave.freq, AudioManager::sAudioFormat.format,
-                           AudioManager::sAudioFormat.channels, AudioManager::sAudioFormat.freq)};
+    const long long modificationTime {Utils::FileSystem::getFileModificationTime(mPath)};
+    const SDL_AudioSpec& deviceFormat {AudioManager::sAudioFormat};
 
-    if (conversionStream == nullptr) {
-        LOG(LogError) << "Failed to create sample conversion stream: " << SDL_GetError();
-        return;
+    auto bankIt = sSampleBank.find(mPath);
+    if (bankIt != sSampleBank.end() && bankIt->second.modificationTime == modificationTime &&
+        bankIt->second.freq == deviceFormat.freq && bankIt->second.format == deviceFormat.format &&
+        bankIt->second.channels == deviceFormat.channels) {
+        mSamples = bankIt->second.samples;
     }
+    else {
+        // Load WAV file via SDL.
+        SDL_AudioSpec wave;
+        Uint8* data {nullptr};
+        Uint32 dlen {0};
+        if (SDL_LoadWAV(mPath.c_str(), &wave, &data, &dlen) == nullptr) {
+            LOG(LogError) << "Failed to load theme navigation sound file: " << SDL_GetError();
+            return;
+        }
+
+        // Convert sound file to the format required by ES-DE.
+        SDL_AudioStream* conversionStream {SDL_NewAudioStream(
+            wave.format, wave.channels, wave.freq, deviceFormat.format, deviceFormat.channels,
+            deviceFormat.freq)};
+
+        if (conversionStream == nullptr) {
+            LOG(LogError) << "Failed to create sample conversion stream: " << SDL_GetError();
+            SDL_FreeWAV(data);
+            return;
+        }
+
+        const int putResult {SDL_AudioStreamPut(conversionStream, data, dlen)};
+        SDL_FreeWAV(data);
+
+        if (putResult == -1) {
+            LOG(LogError) << "Failed to put samples in the conversion stream: " << SDL_GetError();
+            SDL_FreeAudioStream(conversionStream);
+            return;
+        }
+
+        const int sampleLength {SDL_AudioStreamAvailable(conversionStream)};
+
+        auto converted = std::make_shared<std::vector<Uint8>>(sampleLength);
+        if (SDL_AudioStreamGet(conversionStream, converted->data(), sampleLength) == -1) {
+            LOG(LogError) << "Failed to convert sound file '" << mPath << "': " << SDL_GetError();
+            SDL_FreeAudioStream(conversionStream);
+            return;
+        }
 
-    if (SDL_AudioStreamPut(conversionStream, data, dlen) == -1) {
-        LOG(LogError) << "Failed to put samples in the conversion stream: " << SDL_GetError();
         SDL_FreeAudioStream(conversionStream);
-        return;
-    }
-
-    int sampleLength {SDL_AudioStreamAvailable(conversionStream)};
 
-    Uint8* converted {new Uint8[sampleLength]};
-    if (SDL_AudioStreamGet(conversionStream, converted, sampleLength) == -1) {
-        LOG(LogError) << "Failed to convert sound file '" << mPath << "': " << SDL_GetError();
-        SDL_FreeAudioStream(conversionStream);
-        delete[] converted;
-        return;
+        sSampleBank[mPath] = {modificationTime, deviceFormat.freq, deviceFormat.format,
+                              deviceFormat.channels, converted};
+        mSamples = converted;
     }
 
-    mSampleData = converted;
-    mSampleLength = sampleLength;
+    mSampleData = mSamples->data();
+    mSampleLength = static_cast<Uint32>(mSamples->size());
     mSamplePos = 0;
-    mSampleFormat.freq = AudioManager::sAudioFormat.freq;
-    mSampleFormat.channels = AudioManager::sAudioFormat.channels;
-    mSampleFormat.format = AudioManager::sAudioFormat.format;
-    SDL_FreeAudioStream(conversionStream);
-    SDL_FreeWAV(data);
+    mSampleFormat.freq = deviceFormat.freq;
+    mSampleFormat.channels = deviceFormat.channels;
+    mSampleFormat.format = deviceFormat.format;
 }
 
 void Sound::deinit()
@@ -130,8 +153,9 @@ void Sound::deinit()
     mPlaying = false;
 
     if (mSampleData != nullptr) {
+        // The samples are only released by this object, they're still kept in the sample bank.
         SDL_LockAudioDevice(AudioManager::sAudioDevice);
-        delete[] mSampleData;
+        mSamples.reset();
         mSampleData = nullptr;
         mSampleLength = 0;
         mSamplePos = 0;
@@ -47,10 +47,24 @@ public:
 private:
     Sound(const std::string& path = "");
 
+    struct SampleBankEntry {
+        long long modificationTime;
+        int freq;
+        SDL_AudioFormat format;
+        Uint8 channels;
+        std::shared_ptr<const std::vector<Uint8>> samples;
+    };
+
     static inline std::map<std::string, std::shared_ptr<Sound>> sMap;
+    // Decoded samples already converted to the audio device format, keyed by file path and
+    // validated against the file modification time. These are kept for the lifetime of the
+    // application so that theme changes and game launches don't require any decoding.
+    static inline std::map<std::string, SampleBankEntry> sSampleBank;
+
     std::string mPath;
     SDL_AudioSpec mSampleFormat;
-    Uint8* mSampleData;
+    std::shared_ptr<const std::vector<Uint8>> mSamples;
+    const Uint8* mSampleData;
     Uint32 mSamplePos;
     Uint32 mSampleLength;
     std::atomic<bool> mPlaying;
@@ -10,6 +10,7 @@
 
 #include "ThemeData.h"
 
+#include "ApplicationVersion.h"
 #include "Log.h"
 #include "Settings.h"
 #include "components/ImageComponent.h"
@@ -19,7 +20,100 @@
 #include "utils/StringUtil.h"
 
 #include <algorithm>
+#include <fstream>
 #include <pugixml.hpp>
+#include <thread>
+
+// Increase this whenever the compiled theme file format or the theme parsing logic is changed.
+#define COMPILED_THEME_FORMAT_VERSION 2
+// Strings in compiled theme files longer than this are treated as file corruption.
+#define COMPILED_THEME_MAX_STRING_LENGTH 1048576
+
+namespace
+{
+    // Helper functions for the compiled theme files, these are only ever read on the same
+    // machine that wrote them so the values are stored in their native representation.
+    template <typename T> void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeString(std::ostream& stream, const std::string& value)
+    {
+        writeValue(stream, static_cast<uint32_t>(value.size()));
+        stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    template <typename T> bool readValue(std::istream& stream, T& value)
+    {
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<bool>(stream);
+    }
+
+    bool readString(std::istream& stream, std::string& value)
+    {
+        uint32_t size {0};
+        if (!readValue(stream, size) || size > COMPILED_THEME_MAX_STRING_LENGTH)
+            return false;
+        value.resize(size);
+        stream.read(&value[0], static_cast<std::streamsize>(size));
+        return static_cast<bool>(stream);
+    }
+
+    void writeProperty(std::ostream& stream, const ThemeData::ThemeElement::Property& property)
+    {
+        writeValue(stream, static_cast<uint8_t>(property.index()));
+        std::visit(
+            [&stream](auto&& value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same<T, std::string>::value)
+                    writeString(stream, value);
+                else
+                    writeValue(stream, value);
+            },
+            property);
+    }
+
+    template <typename T>
+    bool readPropertyValue(std::istream& stream, ThemeData::ThemeElement::Property& property)
+    {
+        T value {};
+        if constexpr (std::is_same<T, std::string>::value) {
+            if (!readString(stream, value))
+                return false;
+        }
+        else if (!readValue(stream, value)) {
+            return false;
+        }
+        property = value;
+        return true;
+    }
+
+    bool readProperty(std::istream& stream, ThemeData::ThemeElement::Property& property)
+    {
+        uint8_t index {0};
+        if (!readValue(stream, index))
+            return false;
+
+        // Same order as the ThemeElement::Property variant alternatives.
+        switch (index) {
+            case 0:
+                return readPropertyValue<glm::vec4>(stream, property);
+            case 1:
+                return readPropertyValue<glm::vec2>(stream, property);
+            case 2:
+                return readPropertyValue<std::string>(stream, property);
+            case 3:
+                return readPropertyValue<unsigned int>(stream, property);
+            case 4:
+                return readPropertyValue<float>(stream, property);
+            case 5:
+                return readPropertyValue<bool>(stream, property);
+            default:
+                return false;
+        }
+    }
+} // namespace
 
 // clang-format off
 std::vector<std::string> ThemeData::sSupportedViews {
@@ -564,8 +658,12 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>>
 ThemeData::ThemeData()
     : mCustomCollection {false}
 {
-    sCurrentTheme = sThemes.find(Settings::getInstance()->getString("Theme"));
-    sVariantDefinedTransitions = "";
+    // The theme for multiple systems may be loaded in parallel, so only update the static
+    // selections when they actually change.
+    std::unique_lock<std::mutex> lock {sThemeSelectionMutex};
+    const auto currentTheme = sThemes.find(Settings::getInstance()->getString("Theme"));
+    if (sCurrentTheme != currentTheme)
+        sCurrentTheme = currentTheme;
 }
 
 void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
@@ -590,22 +688,9 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
 
     mVariables.insert(sysDataMap.cbegin(), sysDataMap.cend());
 
-    pugi::xml_document doc;
-#if defined(_WIN64)
-    pugi::xml_parse_result res {doc.load_file(Utils::String::stringToWideString(path).c_str())};
-#else
-    pugi::xml_parse_result res {doc.load_file(path.c_str())};
-#endif
-    if (!res)
-        throw error << ": XML parsing error: " << res.description();
-
-    pugi::xml_node root {doc.child("theme")};
-    if (!root)
-        throw error << ": Missing <theme> tag";
-
-    // Check if there's an unsupported theme version tag.
-    if (root.child("formatVersion") != nullptr)
-        throw error << ": Unsupported <formatVersion> tag found";
+    mSourceFiles.clear();
+    mSourceFiles.emplace_back(path);
+    mDefinedTransitions = "";
 
     if (sCurrentTheme->second.capabilities.variants.size() > 0) {
         for (auto& variant : sCurrentTheme->second.capabilities.variants)
@@ -649,21 +734,22 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
             mSelectedFontSize = mFontSizes.front();
     }
 
-    sAspectRatioMatch = false;
-    sThemeLanguage = "";
+    std::string selectedAspectRatio {sSelectedAspectRatio};
+    bool aspectRatioMatch {false};
+    std::string themeLanguage;
 
     if (sCurrentTheme->second.capabilities.aspectRatios.size() > 0) {
         if (std::find(sCurrentTheme->second.capabilities.aspectRatios.cbegin(),
                       sCurrentTheme->second.capabilities.aspectRatios.cend(),
                       Settings::getInstance()->getString("ThemeAspectRatio")) !=
             sCurrentTheme->second.capabilities.aspectRatios.cend())
-            sSelectedAspectRatio = Settings::getInstance()->getString("ThemeAspectRatio");
+            selectedAspectRatio = Settings::getInstance()->getString("ThemeAspectRatio");
         else
-            sSelectedAspectRatio = sCurrentTheme->second.capabilities.aspectRatios.front();
+            selectedAspectRatio = sCurrentTheme->second.capabilities.aspectRatios.front();
 
-        if (sSelectedAspectRatio == "automatic") {
+        if (selectedAspectRatio == "automatic") {
             // Auto-detect the closest aspect ratio based on what's available in the theme config.
-            sSelectedAspectRatio = "16:9";
+            selectedAspectRatio = "16:9";
             const float screenAspectRatio {Renderer::getScreenAspectRatio()};
             float diff {std::fabs(sAspectRatioMap["16:9"] - screenAspectRatio)};
 
@@ -675,10 +761,10 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
                     const float newDiff {
                         std::fabs(sAspectRatioMap[aspectRatio] - screenAspectRatio)};
                     if (newDiff < 0.01f)
-                        sAspectRatioMatch = true;
+                        aspectRatioMatch = true;
                     if (newDiff < diff) {
                         diff = newDiff;
-                        sSelectedAspectRatio = aspectRatio;
+                        selectedAspectRatio = aspectRatio;
                     }
                 }
             }
@@ -697,7 +783,7 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
         if (std::find(sCurrentTheme->second.capabilities.languages.cbegin(),
                       sCurrentTheme->second.capabilities.languages.cend(),
                       langSetting) != sCurrentTheme->second.capabilities.languages.cend()) {
-            sThemeLanguage = langSetting;
+            themeLanguage = langSetting;
         }
         else {
             // We assume all locales are in the correct format.
@@ -706,17 +792,54 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
             // different country).
             for (const auto& lang : sCurrentTheme->second.capabilities.languages) {
                 if (lang.substr(0, 2) == currLanguage) {
-                    sThemeLanguage = lang;
+                    themeLanguage = lang;
                     break;
                 }
             }
             // If there is no match then fall back to the default language en_US, which is
             // mandatory for all themes that provide language support.
-            if (sThemeLanguage == "")
-                sThemeLanguage = "en_US";
+            if (themeLanguage == "")
+                themeLanguage = "en_US";
         }
     }
 
+    {
+        // As above, only update the static selections when they actually change.
+        std::unique_lock<std::mutex> lock {sThemeSelectionMutex};
+        if (sSelectedAspectRatio != selectedAspectRatio)
+            sSelectedAspectRatio = selectedAspectRatio;
+        if (sAspectRatioMatch != aspectRatioMatch)
+            sAspectRatioMatch = aspectRatioMatch;
+        if (sThemeLanguage != themeLanguage)
+            sThemeLanguage = themeLanguage;
+    }
+
+    // If in debug mode, then always parse the theme files so that all errors and warnings
+    // are logged when the theme is reloaded.
+    const bool compiledThemeCache {!Settings::getInstance()->getBool("Debug")};
+    const std::string compiledThemePath {
+        compiledThemeCache ? getCompiledThemePath(sysDataMap, path) : ""};
+    const std::string compiledThemeKey {
+        compiledThemeCache ? getCompiledThemeKey(sysDataMap, path) : ""};
+
+    if (compiledThemeCache && loadCompiledTheme(compiledThemePath, compiledThemeKey)) {
+        buildAssetManifests();
+        return;
+    }
+
+    std::string errorDescription;
+    const std::shared_ptr<const pugi::xml_document> doc {getParsedFile(path, errorDescription)};
+    if (doc == nullptr)
+        throw error << ": XML parsing error: " << errorDescription;
+
+    pugi::xml_node root {doc->child("theme")};
+    if (!root)
+        throw error << ": Missing <theme> tag";
+
+    // Check if there's an unsupported theme version tag.
+    if (root.child("formatVersion") != nullptr)
+        throw error << ": Unsupported <formatVersion> tag found";
+
     parseVariables(root);
     parseColorSchemes(root);
     parseFontSizes(root);
@@ -727,6 +850,21 @@ void ThemeData::loadFile(const std::map<std::string, std::string>& sysDataMap,
         throw error << ": Unsupported <feature> tag found";
     parseVariants(root);
     parseAspectRatios(root);
+    buildAssetManifests();
+
+    if (compiledThemeCache)
+        saveCompiledTheme(compiledThemePath, compiledThemeKey);
+}
+
+const ThemeData::AssetManifest& ThemeData::getAssetManifest(const std::string& view) const
+{
+    static const AssetManifest emptyManifest;
+
+    auto viewIt = mViews.find(view);
+    if (viewIt == mViews.cend())
+        return emptyManifest;
+
+    return viewIt->second.assets;
 }
 
 bool ThemeData::hasView(const std::string& view)
@@ -1086,20 +1224,37 @@ unsigned int ThemeData::getHexColor(const std::string& str)
 
 std::string ThemeData::resolvePlaceholders(const std::string& in)
 {
-    if (in.empty())
+    size_t variableBegin {in.find("${")};
+
+    // Most strings don't contain any variables.
+    if (variableBegin == std::string::npos)
         return in;
 
-    const size_t variableBegin {in.find("${")};
-    const size_t variableEnd {in.find("}", variableBegin)};
+    std::string resolved;
+    resolved.reserve(in.size());
+    size_t position {0};
 
-    if ((variableBegin == std::string::npos) || (variableEnd == std::string::npos))
-        return in;
+    // The resolved values are not resolved again, and undefined variables resolve to
+    // empty strings.
+    while (variableBegin != std::string::npos) {
+        const size_t variableEnd {in.find('}', variableBegin)};
+        if (variableEnd == std::string::npos)
+            break;
+
+        resolved.append(in, position, variableBegin - position);
 
-    std::string prefix {in.substr(0, variableBegin)};
-    std::string replace {in.substr(variableBegin + 2, variableEnd - (variableBegin + 2))};
-    std::string suffix {resolvePlaceholders(in.substr(variableEnd + 1).c_str())};
+        const std::string_view variable {in.data() + variableBegin + 2,
+                                         variableEnd - (variableBegin + 2)};
+        auto it = mVariables.find(variable);
+        if (it != mVariables.end())
+            resolved.append(it->second);
 
-    return prefix + mVariables[replace] + suffix;
+        position = variableEnd + 1;
+        variableBegin = in.find("${", position);
+    }
+
+    resolved.append(in, position, std::string::npos);
+    return resolved;
 }
 
 ThemeData::ThemeCapability ThemeData::parseThemeCapabilities(const std::string& path)
@@ -1733,6 +1888,324 @@ ThemeData::ThemeCapability ThemeData::parseThemeCapabilities(const std::string&
     return capabilities;
 }
 
+unsigned int ThemeData::getPropertyID(const std::string& name)
+{
+    const unsigned int propertyID {findPropertyID(name)};
+    if (propertyID != UNKNOWN_PROPERTY_ID)
+        return propertyID;
+
+    // The themes for multiple systems may be parsed in parallel, so check again after
+    // acquiring the exclusive lock.
+    std::unique_lock<std::shared_mutex> lock {sAttributePropertyMutex};
+    auto it = sAttributePropertyIDs.find(name);
+    if (it != sAttributePropertyIDs.end())
+        return it->second;
+
+    const unsigned int attributePropertyID {static_cast<unsigned int>(
+        getPropertyTable().names.size() + sAttributePropertyNames.size())};
+    sAttributePropertyNames.emplace_back(name);
+    sAttributePropertyIDs[name] = attributePropertyID;
+    return attributePropertyID;
+}
+
+unsigned int ThemeData::findPropertyID(const std::string& name)
+{
+    const PropertyTable& table {getPropertyTable()};
+    auto it = table.ids.find(name);
+    if (it != table.ids.end())
+        return it->second;
+
+    std::shared_lock<std::shared_mutex> lock {sAttributePropertyMutex};
+    auto attributeIt = sAttributePropertyIDs.find(name);
+    return (attributeIt != sAttributePropertyIDs.end() ? attributeIt->second :
+                                                         UNKNOWN_PROPERTY_ID);
+}
+
+const std::string& ThemeData::getPropertyName(const unsigned int propertyID)
+{
+    const PropertyTable& table {getPropertyTable()};
+    if (propertyID < table.names.size())
+        return table.names[propertyID];
+
+    std::shared_lock<std::shared_mutex> lock {sAttributePropertyMutex};
+    return sAttributePropertyNames.at(propertyID - table.names.size());
+}
+
+const ThemeData::PropertyTable& ThemeData::getPropertyTable()
+{
+    // Initialized on first use, which is thread-safe.
+    static const PropertyTable table {[] {
+        PropertyTable propertyTable;
+        for (auto& elementType : sElementMap) {
+            for (auto& property : elementType.second) {
+                if (propertyTable.ids.find(property.first) != propertyTable.ids.end())
+                    continue;
+                propertyTable.ids[property.first] =
+                    static_cast<unsigned int>(propertyTable.names.size());
+                propertyTable.names.emplace_back(property.first);
+            }
+        }
+        return propertyTable;
+    }()};
+
+    return table;
+}
+
+std::string ThemeData::getCompiledThemeKey(const std::map<std::string, std::string>& sysDataMap,
+                                           const std::string& path)
+{
+    // Everything that affects the resolved theme configuration, apart from the contents of
+    // the theme files themselves which are checked using their modification times.
+    std::string key {PROGRAM_VERSION_STRING};
+    key.append("\n").append(path).append("\n").append(mCustomCollection ? "1" : "0");
+
+    for (auto& variable : sysDataMap)
+        key.append("\n").append(variable.first).append("=").append(variable.second);
+
+    key.append("\nvariant=").append(mSelectedVariant);
+    key.append("\noverrideVariant=").append(mOverrideVariant);
+    key.append("\ncolorScheme=").append(mSelectedColorScheme);
+    key.append("\nfontSize=").append(mSelectedFontSize);
+    key.append("\naspectRatio=").append(sSelectedAspectRatio);
+    key.append("\nlanguage=").append(sThemeLanguage);
+
+    return key;
+}
+
+std::string ThemeData::getCompiledThemePath(const std::map<std::string, std::string>& sysDataMap,
+                                            const std::string& path)
+{
+    // There is a single compiled theme per system, so changing any of the theme options
+    // simply replaces the file.
+    std::string systemKey {path};
+    for (auto& variable : sysDataMap)
+        systemKey.append("\n").append(variable.first).append("=").append(variable.second);
+
+    return Utils::FileSystem::getAppDataDirectory() + "/cache/themes/" +
+           Utils::Math::md5Hash(systemKey, false) + ".bin";
+}
+
+bool ThemeData::loadCompiledTheme(const std::string& compiledThemePath, const std::string& key)
+{
+    if (!Utils::FileSystem::exists(compiledThemePath))
+        return false;
+
+#if defined(_WIN64)
+    std::ifstream stream {Utils::String::stringToWideString(compiledThemePath).c_str(),
+                          std::ios::binary};
+#else
+    std::ifstream stream {compiledThemePath, std::ios::binary};
+#endif
+    if (!stream.is_open())
+        return false;
+
+    uint32_t formatVersion {0};
+    std::string fileKey;
+
+    if (!readValue(stream, formatVersion) || formatVersion != COMPILED_THEME_FORMAT_VERSION ||
+        !readString(stream, fileKey) || fileKey != key)
+        return false;
+
+    // The compiled theme is only valid if none of the files it was built from have changed.
+    uint32_t count {0};
+    if (!readValue(stream, count))
+        return false;
+
+    std::vector<std::string> sourceFiles;
+    for (uint32_t i {0}; i < count; ++i) {
+        std::string sourceFile;
+        long long modificationTime {0};
+        if (!readString(stream, sourceFile) || !readValue(stream, modificationTime) ||
+            Utils::FileSystem::getFileModificationTime(sourceFile) != modificationTime)
+            return false;
+        sourceFiles.emplace_back(sourceFile);
+    }
+
+    std::map<std::string, std::string, std::less<>> variables;
+    if (!readValue(stream, count))
+        return false;
+
+    for (uint32_t i {0}; i < count; ++i) {
+        std::string name;
+        std::string value;
+        if (!readString(stream, name) || !readString(stream, value))
+            return false;
+        variables[name] = value;
+    }
+
+    std::map<std::string, ThemeView> views;
+    if (!readValue(stream, count))
+        return false;
+
+    for (uint32_t i {0}; i < count; ++i) {
+        std::string viewName;
+        uint32_t elementCount {0};
+        if (!readString(stream, viewName) || !readValue(stream, elementCount))
+            return false;
+
+        ThemeView& view {views[viewName]};
+        for (uint32_t j {0}; j < elementCount; ++j) {
+            std::string elementName;
+            uint32_t propertyCount {0};
+            if (!readString(stream, elementName))
+                return false;
+
+            ThemeElement& element {view.elements[elementName]};
+            if (!readString(stream, element.type) || !readValue(stream, propertyCount))
+                return false;
+
+            for (uint32_t k {0}; k < propertyCount; ++k) {
+                std::string propertyName;
+                if (!readString(stream, propertyName))
+                    return false;
+
+                ThemeElement::Property property;
+                if (!readProperty(stream, property))
+                    return false;
+                element.set(getPropertyID(propertyName), property);
+            }
+        }
+    }
+
+    std::string definedTransitions;
+    if (!readString(stream, definedTransitions))
+        return false;
+
+    mSourceFiles = std::move(sourceFiles);
+    mVariables = std::move(variables);
+    mViews = std::move(views);
+    mDefinedTransitions = definedTransitions;
+
+    return true;
+}
+
+void ThemeData::saveCompiledTheme(const std::string& compiledThemePath, const std::string& key)
+{
+    const std::string cacheDirectory {Utils::FileSystem::getParent(compiledThemePath)};
+
+    if (!Utils::FileSystem::isDirectory(cacheDirectory) &&
+        !Utils::FileSystem::createDirectory(cacheDirectory)) {
+        LOG(LogWarning) << "ThemeData::saveCompiledTheme(): Couldn't create directory \""
+                        << cacheDirectory << "\"";
+        return;
+    }
+
+    // The file is written under a temporary name and then renamed, so that an interrupted write
+    // or multiple themes being saved at the same time never leaves a partial file behind.
+    const std::string temporaryPath {
+        compiledThemePath + "." +
+        std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id())) + ".tmp"};
+
+#if defined(_WIN64)
+    std::ofstream stream {Utils::String::stringToWideString(temporaryPath).c_str(),
+                          std::ios::binary | std::ios::trunc};
+#else
+    std::ofstream stream {temporaryPath, std::ios::binary | std::ios::trunc};
+#endif
+    if (!stream.is_open()) {
+        LOG(LogWarning) << "ThemeData::saveCompiledTheme(): Couldn't write to file \""
+                        << temporaryPath << "\"";
+        return;
+    }
+
+    writeValue(stream, static_cast<uint32_t>(COMPILED_THEME_FORMAT_VERSION));
+    writeString(stream, key);
+
+    writeValue(stream, static_cast<uint32_t>(mSourceFiles.size()));
+    for (auto& sourceFile : mSourceFiles) {
+        writeString(stream, sourceFile);
+        writeValue(stream, Utils::FileSystem::getFileModificationTime(sourceFile));
+    }
+
+    writeValue(stream, static_cast<uint32_t>(mVariables.size()));
+    for (auto& variable : mVariables) {
+        writeString(stream, variable.first);
+        writeString(stream, variable.second);
+    }
+
+    writeValue(stream, static_cast<uint32_t>(mViews.size()));
+    for (auto& view : mViews) {
+        writeString(stream, view.first);
+        writeValue(stream, static_cast<uint32_t>(view.second.elements.size()));
+
+        for (auto& element : view.second.elements) {
+            writeString(stream, element.first);
+            writeString(stream, element.second.type);
+            writeValue(stream, static_cast<uint32_t>(element.second.properties.size()));
+
+            // The property IDs are only valid during the current session so the names are stored.
+            for (auto& property : element.second.properties) {
+                writeString(stream, getPropertyName(property.first));
+                writeProperty(stream, property.second);
+            }
+        }
+    }
+
+    writeString(stream, mDefinedTransitions);
+    stream.close();
+
+    if (stream.fail()) {
+        LOG(LogWarning) << "ThemeData::saveCompiledTheme(): Couldn't write to file \""
+                        << temporaryPath << "\"";
+        Utils::FileSystem::removeFile(temporaryPath);
+        return;
+    }
+
+#if defined(_WIN64)
+    // Renaming fails on Windows if the destination file exists.
+    if (Utils::FileSystem::exists(compiledThemePath))
+        Utils::FileSystem::removeFile(compiledThemePath);
+#endif
+
+    if (Utils::FileSystem::renameFile(temporaryPath, compiledThemePath, true)) {
+        LOG(LogWarning) << "ThemeData::saveCompiledTheme(): Couldn't rename file \""
+                        << temporaryPath << "\" to \"" << compiledThemePath << "\"";
+        Utils::FileSystem::removeFile(temporaryPath);
+    }
+}
+
+std::shared_ptr<const pugi::xml_document> ThemeData::getParsedFile(const std::string& path,
+                                                                  std::string& errorDescription)
+{
+    // The same include files are typically used by all systems, so caching these avoids
+    // parsing them over and over again. Only the parsing is shared as the variables and
+    // therefore the resolved values are different for each system.
+    const long long modificationTime {Utils::FileSystem::getFileModificationTime(path)};
+    std::promise<ParsedFile> parsePromise;
+    std::shared_future<ParsedFile> parsedFile;
+    bool parseFile {false};
+
+    {
+        std::unique_lock<std::mutex> lock {sParsedFileCacheMutex};
+        auto it = sParsedFileCache.find(path);
+        if (it != sParsedFileCache.end() && it->second.first == modificationTime) {
+            parsedFile = it->second.second;
+        }
+        else {
+            parsedFile = parsePromise.get_future().share();
+            sParsedFileCache[path] = std::make_pair(modificationTime, parsedFile);
+            parseFile = true;
+        }
+    }
+
+    if (parseFile) {
+        std::shared_ptr<pugi::xml_document> doc {std::make_shared<pugi::xml_document>()};
+#if defined(_WIN64)
+        pugi::xml_parse_result result {
+            doc->load_file(Utils::String::stringToWideString(path).c_str())};
+#else
+        pugi::xml_parse_result result {doc->load_file(path.c_str())};
+#endif
+        if (result)
+            parsePromise.set_value(ParsedFile {doc, ""});
+        else
+            parsePromise.set_value(ParsedFile {nullptr, result.description()});
+    }
+
+    errorDescription = parsedFile.get().errorDescription;
+    return parsedFile.get().document;
+}
+
 void ThemeData::parseIncludes(const pugi::xml_node& root)
 {
     for (pugi::xml_node node {root.child("include")}; node; node = node.next_sibling("include")) {
@@ -1746,6 +2219,8 @@ void ThemeData::parseIncludes(const pugi::xml_node& root)
 
         std::string relPath {resolvePlaceholders(node.text().as_string())};
         std::string path {Utils::FileSystem::resolveRelativePath(relPath, mPaths.back(), true)};
+        // Missing files are recorded as well, as the compiled theme is invalid if they appear.
+        mSourceFiles.emplace_back(path);
 
         if (!ResourceManager::getInstance().fileExists(path)) {
             // For explicit paths, throw an error if the file couldn't be found, but only
@@ -1780,17 +2255,13 @@ void ThemeData::parseIncludes(const pugi::xml_node& root)
 
         mPaths.push_back(path);
 
-        pugi::xml_document includeDoc;
-#if defined(_WIN64)
-        pugi::xml_parse_result result {
-            includeDoc.load_file(Utils::String::stringToWideString(path).c_str())};
-#else
-        pugi::xml_parse_result result {includeDoc.load_file(path.c_str())};
-#endif
-        if (!result)
-            throw error << ": Error parsing file: " << result.description();
+        std::string errorDescription;
+        const std::shared_ptr<const pugi::xml_document> includeDoc {
+            getParsedFile(path, errorDescription)};
+        if (includeDoc == nullptr)
+            throw error << ": Error parsing file: " << errorDescription;
 
-        pugi::xml_node theme {includeDoc.child("theme")};
+        pugi::xml_node theme {includeDoc->child("theme")};
         if (!theme)
             throw error << ": Missing <theme> tag";
 
@@ -2001,7 +2472,7 @@ void ThemeData::parseTransitions(const pugi::xml_node& root)
             throw error << ": <transitions> value \"" << transitionsValue
                         << "\" is not matching any defined transitions";
         }
-        sVariantDefinedTransitions = transitionsValue;
+        mDefinedTransitions = transitionsValue;
     }
 }
 
@@ -2136,6 +2607,61 @@ void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view)
     }
 }
 
+void ThemeData::buildAssetManifests()
+{
+    for (auto& [viewName, view] : mViews) {
+        AssetManifest& assets {view.assets};
+        assets = {};
+
+        for (auto& [elementName, element] : view.elements) {
+            // Only image elements are included as the texture flags need to match the ones
+            // used by ImageComponent for the preloaded textures to be shared with it.
+            if (element.type != "image" || (element.has("visible") && !element.get<bool>("visible")))
+                continue;
+
+            ImageAsset asset;
+            asset.tile = element.has("tile") && element.get<bool>("tile");
+            asset.linearMagnify = false;
+
+            if (asset.tile && element.has("tileSize") &&
+                element.get<glm::vec2>("tileSize") == glm::vec2 {0.0f, 0.0f})
+                asset.tile = false;
+
+            // Same as ImageComponent, arbitrarily rotated images use linear interpolation
+            // unless explicitly set.
+            if (element.has("rotation")) {
+                const float rotation {std::abs(element.get<float>("rotation"))};
+                if (rotation != 0.0f &&
+                    (std::round(rotation) != rotation || static_cast<int>(rotation) % 90 != 0))
+                    asset.linearMagnify = true;
+            }
+            if (element.has("interpolation")) {
+                const std::string& interpolation {element.get<std::string>("interpolation")};
+                if (interpolation == "linear")
+                    asset.linearMagnify = true;
+                else if (interpolation == "nearest")
+                    asset.linearMagnify = false;
+            }
+
+            for (const std::string property : {"path", "default"}) {
+                if (!element.has(property))
+                    continue;
+
+                asset.path = element.get<std::string>(property);
+                if (asset.path.empty())
+                    continue;
+
+                if (std::find_if(assets.images.cbegin(), assets.images.cend(),
+                                 [&asset](const ImageAsset& image) {
+                                     return image.path == asset.path && image.tile == asset.tile &&
+                                            image.linearMagnify == asset.linearMagnify;
+                                 }) == assets.images.cend())
+                    assets.images.emplace_back(asset);
+            }
+        }
+    }
+}
+
 void ThemeData::parseElement(const pugi::xml_node& root,
                              const std::map<std::string, ElementPropertyType>& typeMap,
                              ThemeElement& element)
@@ -2208,7 +2734,7 @@ void ThemeData::parseElement(const pugi::xml_node& root,
                                      static_cast<float>(atof(splits.at(3).c_str()))};
                 }
 
-                element.properties[node.name()] = val;
+                element.set(getPropertyID(node.name()), val);
                 break;
             }
             case NORMALIZED_PAIR: {
@@ -2223,11 +2749,11 @@ void ThemeData::parseElement(const pugi::xml_node& root,
                 glm::vec2 val {static_cast<float>(atof(first.c_str())),
                                static_cast<float>(atof(second.c_str()))};
 
-                element.properties[node.name()] = val;
+                element.set(getPropertyID(node.name()), val);
                 break;
             }
             case STRING: {
-                element.properties[node.name()] = str;
+                element.set(getPropertyID(node.name()), str);
                 break;
             }
             case PATH: {
@@ -2282,12 +2808,12 @@ void ThemeData::parseElement(const pugi::xml_node& root,
                                       << nodeName << "\")";
                     }
                 }
-                element.properties[nodeName] = path;
+                element.set(getPropertyID(nodeName), path);
                 break;
             }
             case COLOR: {
                 try {
-                    element.properties[node.name()] = getHexColor(str);
+                    element.set(getPropertyID(node.name()), getHexColor(str));
                 }
                 catch (ThemeException& e) {
                     throw error << ": " << e.what();
@@ -2296,12 +2822,12 @@ void ThemeData::parseElement(const pugi::xml_node& root,
             }
             case UNSIGNED_INTEGER: {
                 unsigned int integerVal {static_cast<unsigned int>(strtoul(str.c_str(), 0, 0))};
-                element.properties[node.name()] = integerVal;
+                element.set(getPropertyID(node.name()), integerVal);
                 break;
             }
             case FLOAT: {
                 float floatVal {static_cast<float>(strtod(str.c_str(), 0))};
-                element.properties[node.name()] = floatVal;
+                element.set(getPropertyID(node.name()), floatVal);
                 break;
             }
             case BOOLEAN: {
@@ -2313,7 +2839,7 @@ void ThemeData::parseElement(const pugi::xml_node& root,
                         boolVal = true;
                 }
 
-                element.properties[node.name()] = boolVal;
+                element.set(getPropertyID(node.name()), boolVal);
                 break;
             }
             default: {
@@ -19,11 +19,22 @@
 #include <algorithm>
 #include <any>
 #include <deque>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 
+namespace pugi
+{
+    class xml_document;
+}
+
 namespace ThemeFlags
 {
     // clang-format off
@@ -96,58 +107,92 @@ public:
     public:
         std::string type;
 
-        struct Property {
-            void operator=(const glm::vec4& value)
-            {
-                r = value;
-                const glm::vec4 initVector {value};
-                v = glm::vec2 {initVector.x, initVector.y};
+        // A normalized rect can also be read as a normalized pair, which is then its first
+        // two values.
+        using Property = std::variant<glm::vec4, glm::vec2, std::string, unsigned int, float, bool>;
+
+        // Property IDs and values, sorted by ID. The IDs are interned property names, see
+        // ThemeData::getPropertyID().
+        std::vector<std::pair<unsigned int, Property>> properties;
+
+        template <typename T> const T get(const unsigned int propertyID) const
+        {
+            auto it = findProperty(propertyID);
+            if (it == properties.cend() || it->first != propertyID)
+                throw std::out_of_range {"ThemeElement::get(): Property not found"};
+
+            if constexpr (std::is_same<T, glm::vec2>::value) {
+                if (std::holds_alternative<glm::vec4>(it->second)) {
+                    const glm::vec4& rect {std::get<glm::vec4>(it->second)};
+                    return glm::vec2 {rect.x, rect.y};
+                }
             }
-            void operator=(const glm::vec2& value) { v = value; }
-            void operator=(const std::string& value) { s = value; }
-            void operator=(const unsigned int& value) { i = value; }
-            void operator=(const float& value) { f = value; }
-            void operator=(const bool& value) { b = value; }
-
-            glm::vec4 r;
-            glm::vec2 v;
-            std::string s;
-            unsigned int i;
-            float f;
-            bool b;
-        };
-
-        std::map<std::string, Property> properties;
+            return std::get<T>(it->second);
+        }
 
         template <typename T> const T get(const std::string& prop) const
         {
-            if (std::is_same<T, glm::vec2>::value)
-                return std::any_cast<const T>(properties.at(prop).v);
-            else if (std::is_same<T, std::string>::value)
-                return std::any_cast<const T>(properties.at(prop).s);
-            else if (std::is_same<T, unsigned int>::value)
-                return std::any_cast<const T>(properties.at(prop).i);
-            else if (std::is_same<T, float>::value)
-                return std::any_cast<const T>(properties.at(prop).f);
-            else if (std::is_same<T, bool>::value)
-                return std::any_cast<const T>(properties.at(prop).b);
-            else if (std::is_same<T, glm::vec4>::value)
-                return std::any_cast<const T>(properties.at(prop).r);
-            return T();
+            return get<T>(findPropertyID(prop));
+        }
+
+        bool has(const unsigned int propertyID) const
+        {
+            auto it = findProperty(propertyID);
+            return (it != properties.cend() && it->first == propertyID);
         }
 
-        bool has(const std::string& prop) const
+        bool has(const std::string& prop) const { return has(findPropertyID(prop)); }
+
+        void set(const unsigned int propertyID, const Property& value)
         {
-            return (properties.find(prop) != properties.cend());
+            auto it = std::lower_bound(
+                properties.begin(), properties.end(), propertyID,
+                [](const auto& property, const unsigned int id) { return property.first < id; });
+            if (it != properties.end() && it->first == propertyID)
+                it->second = value;
+            else
+                properties.insert(it, std::make_pair(propertyID, value));
+        }
+
+    private:
+        std::vector<std::pair<unsigned int, Property>>::const_iterator findProperty(
+            const unsigned int propertyID) const
+        {
+            return std::lower_bound(
+                properties.cbegin(), properties.cend(), propertyID,
+                [](const auto& property, const unsigned int id) { return property.first < id; });
         }
     };
 
+    // Property names are interned to integer IDs when the theme is parsed, which makes the
+    // property lookups cheap and the elements compact. getPropertyID() adds the name if it's
+    // not already interned while findPropertyID() returns UNKNOWN_PROPERTY_ID in this case.
+    static constexpr unsigned int UNKNOWN_PROPERTY_ID {0xFFFFFFFF};
+    static unsigned int getPropertyID(const std::string& name);
+    static unsigned int findPropertyID(const std::string& name);
+    static const std::string& getPropertyName(const unsigned int propertyID);
+
     ThemeData();
 
+    // An image referenced by an image element, along with the texture flags that the element
+    // will be loaded with.
+    struct ImageAsset {
+        std::string path;
+        bool tile;
+        bool linearMagnify;
+    };
+
+    // The static images referenced by the elements of a view, which can be loaded ahead of the
+    // view being displayed.
+    struct AssetManifest {
+        std::vector<ImageAsset> images;
+    };
+
     class ThemeView
     {
     public:
         std::map<std::string, ThemeElement> elements;
+        AssetManifest assets;
     };
 
     struct ThemeVariant {
@@ -220,6 +265,10 @@ public:
     const ThemeElement* getElement(const std::string& view,
                                    const std::string& element,
                                    const std::string& expectedType) const;
+    // Returns an empty manifest if the view is not defined.
+    const AssetManifest& getAssetManifest(const std::string& view) const;
+    // The transitions defined by the selected variant, empty if not defined.
+    const std::string& getDefinedTransitions() const { return mDefinedTransitions; }
 
     static void populateThemes();
     const static std::map<std::string, Theme, StringComparator>& getThemes() { return sThemes; }
@@ -228,6 +277,19 @@ public:
     const static std::string getAspectRatioLabel(const std::string& aspectRatio);
     const static std::string getLanguageLabel(const std::string& language);
     static void setThemeTransitions();
+    // Sets the variant-defined transitions used by setThemeTransitions(). This is not done when
+    // loading a theme file as the themes for multiple systems may be loaded in parallel.
+    static void setVariantDefinedTransitions(const std::string& transitions)
+    {
+        sVariantDefinedTransitions = transitions;
+    }
+    // Parsed theme files are shared by all systems within a theme loading pass, this is to be
+    // called when the pass is completed to free the memory.
+    static void clearParsedFileCache()
+    {
+        std::unique_lock<std::mutex> lock {sParsedFileCacheMutex};
+        sParsedFileCache.clear();
+    }
 
     const std::map<ThemeTriggers::TriggerType, std::pair<std::string, std::vector<std::string>>>
     getCurrentThemeSelectedVariantOverrides();
@@ -244,7 +306,8 @@ public:
         BOOLEAN
     };
 
-    std::map<std::string, std::string> mVariables;
+    // Transparent comparator to allow variable lookups without creating temporary strings.
+    std::map<std::string, std::string, std::less<>> mVariables;
 
 private:
     unsigned int getHexColor(const std::string& str);
@@ -252,6 +315,19 @@ private:
 
     static ThemeCapability parseThemeCapabilities(const std::string& path);
 
+    // The compiled theme is the fully resolved theme configuration for a system, which is
+    // stored on disk to avoid having to parse the theme files on every startup.
+    std::string getCompiledThemeKey(const std::map<std::string, std::string>& sysDataMap,
+                                    const std::string& path);
+    static std::string getCompiledThemePath(const std::map<std::string, std::string>& sysDataMap,
+                                            const std::string& path);
+    bool loadCompiledTheme(const std::string& compiledThemePath, const std::string& key);
+    void saveCompiledTheme(const std::string& compiledThemePath, const std::string& key);
+    // Returns the parsed XML document, which is reused if the file has not been modified since
+    // it was last parsed. On parsing errors nullptr is returned and the description is set.
+    static std::shared_ptr<const pugi::xml_document> getParsedFile(const std::string& path,
+                                                                   std::string& errorDescription);
+
     void parseIncludes(const pugi::xml_node& root);
     void parseVariants(const pugi::xml_node& root);
     void parseColorSchemes(const pugi::xml_node& root);
@@ -262,6 +338,7 @@ private:
     void parseVariables(const pugi::xml_node& root);
     void parseViews(const pugi::xml_node& root);
     void parseView(const pugi::xml_node& root, ThemeView& view);
+    void buildAssetManifests();
     void parseElement(const pugi::xml_node& root,
                       const std::map<std::string, ElementPropertyType>& typeMap,
                       ThemeElement& element);
@@ -284,12 +361,42 @@ private:
     static std::map<std::string, std::map<std::string, std::string>> sPropertyAttributeMap;
     static std::map<std::string, std::map<std::string, ElementPropertyType>> sElementMap;
 
+    struct PropertyTable {
+        std::unordered_map<std::string, unsigned int> ids;
+        std::vector<std::string> names;
+    };
+    // The names of all properties in sElementMap, interned on first use and never modified
+    // afterwards so the lookups for these don't need any locking.
+    static const PropertyTable& getPropertyTable();
+
     static inline std::map<std::string, Theme, StringComparator> sThemes;
     static inline std::map<std::string, Theme, StringComparator>::iterator sCurrentTheme {};
     static inline std::string sVariantDefinedTransitions;
+    struct ParsedFile {
+        std::shared_ptr<const pugi::xml_document> document;
+        std::string errorDescription;
+    };
+
+    // File path, file modification time and parsed file. The themes for multiple systems may
+    // be loaded in parallel, in which case a file is parsed by the first thread requesting it
+    // while the other threads wait for the result.
+    static inline std::map<std::string, std::pair<long long, std::shared_future<ParsedFile>>>
+        sParsedFileCache;
+    static inline std::mutex sParsedFileCacheMutex;
+    // Property names that are not known upfront, i.e. names that are prefixed by an attribute
+    // value. Their IDs follow the IDs of the property table.
+    static inline std::unordered_map<std::string, unsigned int> sAttributePropertyIDs;
+    // A deque is used as it doesn't invalidate references to the names when growing.
+    static inline std::deque<std::string> sAttributePropertyNames;
+    static inline std::shared_mutex sAttributePropertyMutex;
+    // Protects the static theme selections which are set when loading the theme files.
+    static inline std::mutex sThemeSelectionMutex;
 
     std::map<std::string, ThemeView> mViews;
     std::deque<std::string> mPaths;
+    // All files read when loading the theme, used for invalidating the compiled theme.
+    std::vector<std::string> mSourceFiles;
+    std::string mDefinedTransitions;
     std::vector<std::string> mVariants;
     std::vector<std::string> mColorSchemes;
     std::vector<std::string> mFontSizes;
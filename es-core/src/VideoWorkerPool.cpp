@@ -0,0 +1,174 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  VideoWorkerPool.cpp
+//
+//  Worker threads shared by all video players, used for reading, decoding and filtering
+//  the video and audio frames. The total number of threads is kept within a global budget
+//  and the video players with the highest priority are processed first, so that multiple
+//  concurrent videos degrade gracefully on CPUs with few cores.
+//
+
+#include "VideoWorkerPool.h"
+
+#include "Log.h"
+#include "Settings.h"
+
+#include <algorithm>
+
+// Minimum time between two processing calls for the same player, this makes sure that the
+// workers do not consume all available CPU cycles.
+#define PLAYER_PROCESSING_INTERVAL 1
+// The thread budget is set to the number of CPU cores if not configured, within these limits.
+#define MIN_AUTO_THREAD_BUDGET 2
+#define MAX_AUTO_THREAD_BUDGET 8
+#define MAX_THREAD_BUDGET 32
+
+VideoWorkerPool::VideoWorkerPool()
+    : mNextPlayerID {1}
+    , mRunCounter {0}
+    , mThreadBudget {0}
+    , mShutdown {false}
+{
+}
+
+VideoWorkerPool::~VideoWorkerPool()
+{
+    {
+        std::unique_lock<std::mutex> lock {mMutex};
+        mShutdown = true;
+    }
+
+    mCondition.notify_all();
+
+    for (auto& worker : mWorkers)
+        worker.join();
+}
+
+VideoWorkerPool& VideoWorkerPool::getInstance()
+{
+    static VideoWorkerPool instance;
+    return instance;
+}
+
+unsigned int VideoWorkerPool::addPlayer(const std::function<void()>& processFunction,
+                                        const float priority)
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+
+    if (mWorkers.empty())
+        startWorkers();
+
+    const unsigned int playerID {mNextPlayerID++};
+    mPlayers[playerID] = Player {processFunction, priority, false, clock::now(), 0};
+
+    lock.unlock();
+    mCondition.notify_one();
+
+    return playerID;
+}
+
+void VideoWorkerPool::removePlayer(const unsigned int playerID)
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+
+    auto it = mPlayers.find(playerID);
+    if (it == mPlayers.end())
+        return;
+
+    mCondition.wait(lock, [&it] { return !it->second.running; });
+    mPlayers.erase(it);
+}
+
+void VideoWorkerPool::setPriority(const unsigned int playerID, const float priority)
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+
+    auto it = mPlayers.find(playerID);
+    if (it != mPlayers.end())
+        it->second.priority = priority;
+}
+
+int VideoWorkerPool::getFilterThreadCount(const bool audioFilter)
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+
+    const int playerCount {std::max(1, static_cast<int>(mPlayers.size()))};
+    const int workerCount {static_cast<int>(mWorkers.size())};
+    const int extraThreads {std::max(0, mThreadBudget - workerCount) / playerCount};
+
+    // For some reason the actual libavfilter thread count is one less than specified, and
+    // without any constraints we would use up to two additional threads for the video filter
+    // and one additional thread for the audio filter.
+    if (audioFilter)
+        return 1 + (extraThreads >= 3 ? 1 : 0);
+    else
+        return 1 + std::min(2, extraThreads);
+}
+
+void VideoWorkerPool::startWorkers()
+{
+    mThreadBudget =
+        std::min(Settings::getInstance()->getInt("VideoThreadBudget"), MAX_THREAD_BUDGET);
+
+    if (mThreadBudget <= 0) {
+        mThreadBudget = std::clamp(static_cast<int>(std::thread::hardware_concurrency()),
+                                   MIN_AUTO_THREAD_BUDGET, MAX_AUTO_THREAD_BUDGET);
+    }
+
+    // Half of the budget is used for the worker threads and the rest is shared by the
+    // libavfilter graphs of all players.
+    const int workerCount {std::max(1, mThreadBudget / 2)};
+
+    LOG(LogDebug) << "VideoWorkerPool::startWorkers(): Starting " << workerCount
+                  << " worker threads using a thread budget of " << mThreadBudget;
+
+    for (int i {0}; i < workerCount; ++i)
+        mWorkers.emplace_back(&VideoWorkerPool::workerThread, this);
+}
+
+void VideoWorkerPool::workerThread()
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+
+    while (!mShutdown) {
+        const clock::time_point currentTime {clock::now()};
+        clock::time_point nextRunTime {clock::time_point::max()};
+        Player* nextPlayer {nullptr};
+
+        for (auto& [playerID, player] : mPlayers) {
+            if (player.running)
+                continue;
+            if (player.nextRunTime > currentTime) {
+                nextRunTime = std::min(nextRunTime, player.nextRunTime);
+                continue;
+            }
+            if (nextPlayer == nullptr || player.priority > nextPlayer->priority ||
+                (player.priority == nextPlayer->priority &&
+                 player.lastRun < nextPlayer->lastRun))
+                nextPlayer = &player;
+        }
+
+        if (nextPlayer == nullptr) {
+            if (nextRunTime == clock::time_point::max())
+                mCondition.wait(lock);
+            else
+                mCondition.wait_until(lock, nextRunTime);
+            continue;
+        }
+
+        // The player can't be removed while it's marked as running, so the pointer remains
+        // valid while the mutex is unlocked.
+        nextPlayer->running = true;
+        lock.unlock();
+        nextPlayer->processFunction();
+        lock.lock();
+        nextPlayer->running = false;
+        nextPlayer->lastRun = ++mRunCounter;
+        nextPlayer->nextRunTime =
+            clock::now() + std::chrono::milliseconds(PLAYER_PROCESSING_INTERVAL);
+
+        // Wake up any removePlayer() call waiting for this player.
+        mCondition.notify_all();
+    }
+}
@@ -0,0 +1,68 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  VideoWorkerPool.h
+//
+//  Worker threads shared by all video players, used for reading, decoding and filtering
+//  the video and audio frames. The total number of threads is kept within a global budget
+//  and the video players with the highest priority are processed first, so that multiple
+//  concurrent videos degrade gracefully on CPUs with few cores.
+//
+
+#ifndef ES_CORE_VIDEO_WORKER_POOL_H
+#define ES_CORE_VIDEO_WORKER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class VideoWorkerPool
+{
+public:
+    static VideoWorkerPool& getInstance();
+
+    // Adds a video player, the processing function is then called repeatedly by the worker
+    // threads until the player is removed. Players with a higher priority are processed first.
+    unsigned int addPlayer(const std::function<void()>& processFunction, const float priority);
+    // Blocks until any ongoing call to the processing function for the player has completed.
+    void removePlayer(const unsigned int playerID);
+    void setPriority(const unsigned int playerID, const float priority);
+
+    // Number of threads to use for a libavfilter graph, based on the remaining thread budget
+    // after the worker threads have been accounted for and on the number of video players.
+    int getFilterThreadCount(const bool audioFilter);
+
+private:
+    VideoWorkerPool();
+    ~VideoWorkerPool();
+
+    void startWorkers();
+    void workerThread();
+
+    using clock = std::chrono::steady_clock;
+
+    struct Player {
+        std::function<void()> processFunction;
+        float priority;
+        bool running;
+        clock::time_point nextRunTime;
+        // Used for round-robin ordering of players with the same priority.
+        unsigned long lastRun;
+    };
+
+    std::map<unsigned int, Player> mPlayers;
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+
+    unsigned int mNextPlayerID;
+    unsigned long mRunCounter;
+    int mThreadBudget;
+    bool mShutdown;
+};
+
+#endif // ES_CORE_VIDEO_WORKER_POOL_H
@@ -9,12 +9,15 @@
 
 #include "Window.h"
 
+#include "FrameStatistics.h"
 #include "InputManager.h"
 #include "Log.h"
 #include "Scripting.h"
 #include "Sound.h"
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
+#include "components/LottieAnimComponent.h"
+#include "components/VideoFFmpegComponent.h"
 #include "guis/GuiInfoPopup.h"
 #include "resources/Font.h"
 #include "utils/LocalizationUtil.h"
@@ -389,6 +392,76 @@ void Window::update(int deltaTime)
             ss << "\nFont VRAM: " << fontVramUsageMiB
                << " MiB\nTexture VRAM: " << textureVramUsageMiB
                << " MiB\nMax Texture VRAM: " << textureTotalUsageMiB << " MiB";
+
+            // Glyph atlas.
+            const GlyphAtlasManager::Statistics atlasStats {Font::getGlyphAtlasStatistics()};
+            const unsigned long glyphLookups {atlasStats.glyphHits + atlasStats.glyphMisses};
+            ss << "\nGlyph atlas: " << atlasStats.pageCount << " pages, " << std::setprecision(1)
+               << atlasStats.occupancy * 100.0f << "% used, "
+               << (glyphLookups == 0 ? 0.0f :
+                                       static_cast<float>(atlasStats.glyphHits) /
+                                           static_cast<float>(glyphLookups) * 100.0f)
+               << "% hits, " << atlasStats.pageEvictions << " evictions";
+
+            // Shaped text cache.
+            const Font::ShapedTextCacheStatistics shapingStats {
+                Font::getShapedTextCacheStatistics()};
+            const unsigned long shapingLookups {shapingStats.hits + shapingStats.misses};
+            ss << "\nShaped text cache: " << shapingStats.entries << " entries, "
+               << (shapingLookups == 0 ? 0.0f :
+                                         static_cast<float>(shapingStats.hits) /
+                                             static_cast<float>(shapingLookups) * 100.0f)
+               << "% hits";
+
+            // Frame times for the recent frame history.
+            const FrameStatistics::Summary frameStats {FrameStatistics::getInstance().getSummary()};
+            ss << std::setprecision(2) << "\nFrame time p50/p95/p99: " << frameStats.p50 << " / "
+               << frameStats.p95 << " / " << frameStats.p99 << " ms (worst "
+               << frameStats.worstFrame << " ms)";
+            ss << "\nUpdate/render/swap: "
+               << frameStats.averageSectionTimes[static_cast<size_t>(
+                      FrameStatistics::Section::UPDATE)]
+               << " / "
+               << frameStats.averageSectionTimes[static_cast<size_t>(
+                      FrameStatistics::Section::RENDER)]
+               << " / "
+               << frameStats.averageSectionTimes[static_cast<size_t>(
+                      FrameStatistics::Section::SWAP)]
+               << " ms";
+            ss << std::setprecision(1) << "\nDraw calls: " << frameStats.averageDrawCalls
+               << ", texture uploads: " << frameStats.averageTextureUploads
+               << ", loader queue: " << frameStats.loaderQueueSize;
+
+            // Video frames.
+            const VideoFFmpegComponent::VideoFrameStatistics videoStats {
+                VideoFFmpegComponent::getVideoFrameStatistics()};
+            ss << "\nVideo frames: " << videoStats.decoded << " decoded, " << videoStats.dropped
+               << " dropped, " << videoStats.copied << " copied";
+
+            // Lottie frame cache.
+            const LottieAnimComponent::FrameCacheStatistics lottieStats {
+                LottieAnimComponent::getFrameCacheStatistics()};
+            const unsigned long lottieLookups {lottieStats.hits + lottieStats.misses};
+            ss << "\nLottie frame cache: " << std::setprecision(1)
+               << static_cast<float>(lottieStats.bytes) / 1024.0f / 1024.0f << " MiB, "
+               << (lottieLookups == 0 ? 0.0f :
+                                        static_cast<float>(lottieStats.hits) /
+                                            static_cast<float>(lottieLookups) * 100.0f)
+               << "% hits";
+
+            // Resources registered for unloading and reloading around game launches.
+            ss << "\nReloadable resources: "
+               << ResourceManager::getInstance().getReloadableCount();
+
+            const std::vector<float>& buckets {FrameStatistics::getHistogramBuckets()};
+            ss << std::setprecision(0) << "\nHistogram:";
+            for (size_t i {0}; i < frameStats.histogram.size(); ++i) {
+                if (i < buckets.size())
+                    ss << " <" << buckets[i];
+                else
+                    ss << " >" << buckets.back();
+                ss << ": " << frameStats.histogram[i];
+            }
             mGPUStatisticsText->setText(ss.str());
         }
 
@@ -668,6 +741,10 @@ void Window::render()
 
     if (Settings::getInstance()->getBool("DisplayGPUStatistics"))
         mGPUStatisticsText->render(mRenderer->getIdentity());
+
+    // Glyph atlas pages used during this frame are protected from eviction.
+    Font::nextFrame();
+    TextureResource::nextFrame();
 }
 
 void Window::updateSplashScreenText()
@@ -8,6 +8,9 @@
 
 #define DEBUG_ANIMATION false
 
+// The memory cap in MiB for the frame cache shared by all GIF animations.
+#define FRAME_CACHE_SIZE 256
+
 #if defined(_MSC_VER) // MSVC compiler.
 #define _CRT_SECURE_NO_WARNINGS
 #endif
@@ -26,12 +29,16 @@ GIFAnimComponent::GIFAnimComponent()
     , mAnimFile {nullptr}
     , mAnimation {nullptr}
     , mFrame {nullptr}
+    , mModificationTime {0}
+    , mAnimationUser {false}
     , mStartDirection {"normal"}
     , mTotalFrames {0}
     , mFrameNum {0}
     , mFrameTime {0}
     , mFileWidth {0}
     , mFileHeight {0}
+    , mFrameWidth {0}
+    , mFrameHeight {0}
     , mFrameRate {0.0}
     , mSpeedModifier {1.0f}
     , mTargetPacing {0}
@@ -68,6 +75,8 @@ GIFAnimComponent::GIFAnimComponent()
 
 GIFAnimComponent::~GIFAnimComponent()
 {
+    releaseAnimation();
+
     if (mAnimFile != nullptr) {
         fclose(mAnimFile);
         mAnimFile = nullptr;
@@ -76,13 +85,21 @@ GIFAnimComponent::~GIFAnimComponent()
 
 void GIFAnimComponent::setAnimation(const std::string& path)
 {
+    releaseAnimation();
+
     if (mAnimation != nullptr) {
-        FreeImage_CloseMultiBitmap(mAnimation, 0);
+        // The multipage bitmap is closed after each use, but the file is kept open.
+        if (mAnimFile != nullptr) {
+            fclose(mAnimFile);
+            mAnimFile = nullptr;
+        }
         mAnimation = nullptr;
         mPictureRGBA.clear();
         mLastRenderedFrame = -1;
         mFileWidth = 0;
         mFileHeight = 0;
+        mFrameWidth = 0;
+        mFrameHeight = 0;
     }
 
     mPath = path;
@@ -102,6 +119,8 @@ void GIFAnimComponent::setAnimation(const std::string& path)
         return;
     }
 
+    mModificationTime = Utils::FileSystem::getFileModificationTime(mPath);
+
     FREE_IMAGE_FORMAT fileFormat;
 
 #if defined(_WIN64)
@@ -164,13 +183,13 @@ void GIFAnimComponent::setAnimation(const std::string& path)
     size_t width {0};
     size_t height {0};
 
-    unsigned int filePitch {0};
-
     mTotalFrames = static_cast<size_t>(FreeImage_GetPageCount(mAnimation));
 
     mFileWidth = FreeImage_GetWidth(mFrame);
     mFileHeight = FreeImage_GetHeight(mFrame);
-    filePitch = FreeImage_GetPitch(mFrame);
+
+    FreeImage_UnlockPage(mAnimation, mFrame, false);
+    FreeImage_CloseMultiBitmap(mAnimation, 0);
 
     if (mTargetIsMax || mSize.x == 0.0f || mSize.y == 0.0f) {
         const double sizeRatio {static_cast<double>(mFileWidth) / static_cast<double>(mFileHeight)};
@@ -221,20 +240,28 @@ void GIFAnimComponent::setAnimation(const std::string& path)
     if (!mTargetIsMax)
         mTargetSize = mSize;
 
-    FreeImage_PreMultiplyWithAlpha(mFrame);
-    mPictureRGBA.resize(mFileWidth * mFileHeight * 4);
+    // There is no point in decoding at a higher resolution than what is actually displayed.
+    mFrameWidth = std::max(1u, std::min(mFileWidth, static_cast<unsigned int>(width)));
+    mFrameHeight = std::max(1u, std::min(mFileHeight, static_cast<unsigned int>(height)));
+    mFrameSize = mFrameWidth * mFrameHeight * 4;
 
-    FreeImage_ConvertToRawBits(reinterpret_cast<BYTE*>(&mPictureRGBA.at(0)), mFrame, filePitch, 32,
-                               FI_RGBA_BLUE, FI_RGBA_GREEN, FI_RGBA_RED, 1);
+    mAnimationKey = std::make_tuple(mPath, mModificationTime, mFrameWidth, mFrameHeight);
+    ++sAnimationUsers[mAnimationKey];
+    mAnimationUser = true;
 
-    mTexture->initFromPixels(&mPictureRGBA.at(0), mFileWidth, mFileHeight);
+    const std::vector<uint8_t>* frame {getFrame(0)};
+    if (frame == nullptr) {
+        LOG(LogError) << "GIFAnimComponent::setAnimation(): Couldn't decode animation file \""
+                      << mPath << "\"";
+        mAnimation = nullptr;
+        return;
+    }
 
-    FreeImage_UnlockPage(mAnimation, mFrame, false);
-    FreeImage_CloseMultiBitmap(mAnimation, 0);
+    mTexture->initFromPixels(&frame->at(0), mFrameWidth, mFrameHeight);
+    mLastRenderedFrame = 0;
 
     mDirection = mStartDirection;
     mFrameRate = 1000.0 / static_cast<double>(mFrameTime);
-    mFrameSize = mFileWidth * mFileHeight * 4;
     mTargetPacing = static_cast<int>((1000.0 / mFrameRate) / static_cast<double>(mSpeedModifier));
 
     if (mDirection == "reverse")
@@ -244,6 +271,8 @@ void GIFAnimComponent::setAnimation(const std::string& path)
         const int duration {mTargetPacing * mTotalFrames};
         LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Width: " << mFileWidth;
         LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Height: " << mFileHeight;
+        LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Decoded frame size: " << mFrameWidth
+                      << "x" << mFrameHeight;
         LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Total number of frames: "
                       << mTotalFrames;
         LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Frame rate: " << mFrameRate;
@@ -259,6 +288,9 @@ void GIFAnimComponent::setAnimation(const std::string& path)
                       << std::setprecision(1)
                       << static_cast<double>(mFrameSize * mTotalFrames) / 1024.0 / 1024.0
                       << " MiB)";
+        LOG(LogDebug) << "GIFAnimComponent::setAnimation(): Shared frame cache size: "
+                      << sFrameCacheSize << " bytes (" << std::fixed << std::setprecision(1)
+                      << static_cast<double>(sFrameCacheSize) / 1024.0 / 1024.0 << " MiB)";
     }
 
     mAnimationStartTime = std::chrono::system_clock::now();
@@ -488,8 +520,10 @@ void GIFAnimComponent::render(const glm::mat4& parentTrans)
 
     // This is necessary as there may otherwise be no texture to render when paused.
     if ((mExternalPause || mPause) && mTexture->getSize().x == 0.0f) {
-        mTexture->initFromPixels(&mPictureRGBA.at(0), static_cast<size_t>(mSize.x),
-                                 static_cast<size_t>(mSize.y));
+        const std::vector<uint8_t>* frame {
+            getFrame(glm::clamp(mLastRenderedFrame, 0, mTotalFrames - 1))};
+        if (frame != nullptr)
+            mTexture->initFromPixels(&frame->at(0), mFrameWidth, mFrameHeight);
     }
 
     bool doRender {true};
@@ -542,22 +576,11 @@ void GIFAnimComponent::render(const glm::mat4& parentTrans)
         }
 
         if (!mHoldFrame) {
-            mAnimation = FreeImage_OpenMultiBitmapFromHandle(
-                FIF_GIF, &mAnimIO, static_cast<fi_handle>(mAnimFile), GIF_PLAYBACK);
-
-            mFrame = FreeImage_LockPage(mAnimation, mFrameNum);
-            FreeImage_PreMultiplyWithAlpha(mFrame);
-            mPictureRGBA.clear();
-            mPictureRGBA.resize(mFrameSize);
-
-            FreeImage_ConvertToRawBits(reinterpret_cast<BYTE*>(&mPictureRGBA.at(0)), mFrame,
-                                       FreeImage_GetPitch(mFrame), 32, FI_RGBA_RED, FI_RGBA_GREEN,
-                                       FI_RGBA_BLUE, 1);
-
-            mTexture->initFromPixels(&mPictureRGBA.at(0), mFileWidth, mFileHeight);
-
-            FreeImage_UnlockPage(mAnimation, mFrame, false);
-            FreeImage_CloseMultiBitmap(mAnimation, 0);
+            const std::vector<uint8_t>* frame {getFrame(mFrameNum)};
+            if (frame != nullptr) {
+                mTexture->initFromPixels(&frame->at(0), mFrameWidth, mFrameHeight);
+                mLastRenderedFrame = mFrameNum;
+            }
 
             if (mDirection == "reverse")
                 --mFrameNum;
@@ -611,3 +634,111 @@ void GIFAnimComponent::render(const glm::mat4& parentTrans)
 
     mHoldFrame = true;
 }
+
+const std::vector<uint8_t>* GIFAnimComponent::getFrame(const int frameNum)
+{
+    const FrameCacheKeyType key {
+        std::make_tuple(mPath, mModificationTime, mFrameWidth, mFrameHeight, frameNum)};
+
+    auto it = sFrameCache.find(key);
+    if (it != sFrameCache.end()) {
+        // Move the frame to the front of the LRU list.
+        sFrameCacheLRU.splice(sFrameCacheLRU.begin(), sFrameCacheLRU, it->second.lruPosition);
+        return &it->second.pixels;
+    }
+
+    std::vector<uint8_t> pixels;
+    if (!decodeFrame(frameNum, pixels))
+        return nullptr;
+
+    const size_t maxCacheSize {static_cast<size_t>(FRAME_CACHE_SIZE) * 1024 * 1024};
+
+    // Frames that are too large to ever fit in the cache are only kept by this instance.
+    if (pixels.size() > maxCacheSize) {
+        mPictureRGBA = std::move(pixels);
+        return &mPictureRGBA;
+    }
+
+    while (sFrameCacheSize + pixels.size() > maxCacheSize && !sFrameCacheLRU.empty()) {
+        auto lastIt = sFrameCache.find(*sFrameCacheLRU.back());
+        sFrameCacheSize -= lastIt->second.pixels.size();
+        sFrameCacheLRU.pop_back();
+        sFrameCache.erase(lastIt);
+    }
+
+    sFrameCacheSize += pixels.size();
+    it = sFrameCache.emplace(key, CachedFrame {std::move(pixels), {}}).first;
+    sFrameCacheLRU.emplace_front(&it->first);
+    it->second.lruPosition = sFrameCacheLRU.begin();
+
+    return &it->second.pixels;
+}
+
+void GIFAnimComponent::releaseAnimation()
+{
+    if (!mAnimationUser)
+        return;
+
+    mAnimationUser = false;
+
+    auto usersIt = sAnimationUsers.find(mAnimationKey);
+    if (usersIt == sAnimationUsers.end() || --usersIt->second > 0)
+        return;
+
+    sAnimationUsers.erase(usersIt);
+
+    // Drop the cached frames once the last component using the animation is gone. As the
+    // frame number is the last element of the key, all frames are stored next to each other.
+    auto it = sFrameCache.lower_bound(std::tuple_cat(mAnimationKey, std::make_tuple(0)));
+    while (it != sFrameCache.end() && std::get<0>(it->first) == std::get<0>(mAnimationKey) &&
+           std::get<1>(it->first) == std::get<1>(mAnimationKey) &&
+           std::get<2>(it->first) == std::get<2>(mAnimationKey) &&
+           std::get<3>(it->first) == std::get<3>(mAnimationKey)) {
+        sFrameCacheSize -= it->second.pixels.size();
+        sFrameCacheLRU.erase(it->second.lruPosition);
+        it = sFrameCache.erase(it);
+    }
+}
+
+bool GIFAnimComponent::decodeFrame(const int frameNum, std::vector<uint8_t>& pixels)
+{
+    if (mAnimFile == nullptr)
+        return false;
+
+    FIMULTIBITMAP* animation {FreeImage_OpenMultiBitmapFromHandle(
+        FIF_GIF, &mAnimIO, static_cast<fi_handle>(mAnimFile), GIF_PLAYBACK)};
+
+    if (animation == nullptr)
+        return false;
+
+    FIBITMAP* frame {FreeImage_LockPage(animation, frameNum)};
+    if (frame == nullptr) {
+        FreeImage_CloseMultiBitmap(animation, 0);
+        return false;
+    }
+
+    FIBITMAP* scaledFrame {nullptr};
+    if (mFrameWidth != mFileWidth || mFrameHeight != mFileHeight) {
+        scaledFrame = FreeImage_Rescale(frame, mFrameWidth, mFrameHeight, FILTER_BILINEAR);
+        if (scaledFrame == nullptr) {
+            FreeImage_UnlockPage(animation, frame, false);
+            FreeImage_CloseMultiBitmap(animation, 0);
+            return false;
+        }
+    }
+
+    FIBITMAP* outputFrame {scaledFrame != nullptr ? scaledFrame : frame};
+    FreeImage_PreMultiplyWithAlpha(outputFrame);
+    pixels.resize(static_cast<size_t>(mFrameWidth) * mFrameHeight * 4);
+
+    FreeImage_ConvertToRawBits(reinterpret_cast<BYTE*>(&pixels.at(0)), outputFrame,
+                               mFrameWidth * 4, 32, FI_RGBA_RED, FI_RGBA_GREEN, FI_RGBA_BLUE, 1);
+
+    if (scaledFrame != nullptr)
+        FreeImage_Unload(scaledFrame);
+
+    FreeImage_UnlockPage(animation, frame, false);
+    FreeImage_CloseMultiBitmap(animation, 0);
+
+    return true;
+}
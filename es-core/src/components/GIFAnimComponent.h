@@ -17,6 +17,9 @@
 
 #include <FreeImage.h>
 #include <chrono>
+#include <list>
+#include <map>
+#include <tuple>
 
 class GIFAnimComponent : public GuiComponent
 {
@@ -40,6 +43,11 @@ public:
 private:
     void render(const glm::mat4& parentTrans) override;
 
+    // Returns the frame from the shared frame cache, decoding it first if needed.
+    const std::vector<uint8_t>* getFrame(const int frameNum);
+    bool decodeFrame(const int frameNum, std::vector<uint8_t>& pixels);
+    void releaseAnimation();
+
     static inline unsigned int readProc(void* buffer,
                                         unsigned int size,
                                         unsigned int count,
@@ -68,6 +76,23 @@ private:
         return ftell(reinterpret_cast<FILE*>(handle));
     }
 
+    // Path, file modification time, frame width and frame height.
+    using AnimationKeyType = std::tuple<std::string, long long, unsigned int, unsigned int>;
+    // The animation key followed by the frame number.
+    using FrameCacheKeyType = std::tuple<std::string, long long, unsigned int, unsigned int, int>;
+    struct CachedFrame {
+        std::vector<uint8_t> pixels;
+        std::list<const FrameCacheKeyType*>::iterator lruPosition;
+    };
+
+    // Decoded frames shared by all instances, so the same animation used by multiple elements
+    // is only decoded once. The least recently used frames are evicted first.
+    static inline std::map<FrameCacheKeyType, CachedFrame> sFrameCache;
+    static inline std::list<const FrameCacheKeyType*> sFrameCacheLRU;
+    static inline size_t sFrameCacheSize {0};
+    // Number of components using each animation, its frames are dropped with the last user.
+    static inline std::map<AnimationKeyType, int> sAnimationUsers;
+
     Renderer* mRenderer;
     glm::vec2 mTargetSize;
     std::shared_ptr<TextureResource> mTexture;
@@ -80,6 +105,9 @@ private:
     FIMULTIBITMAP* mAnimation;
     FIBITMAP* mFrame;
     std::string mPath;
+    long long mModificationTime;
+    AnimationKeyType mAnimationKey;
+    bool mAnimationUser;
     std::string mStartDirection;
     std::string mDirection;
     int mTotalFrames;
@@ -88,6 +116,9 @@ private:
 
     unsigned int mFileWidth;
     unsigned int mFileHeight;
+    // The frames are decoded at the display size if this is smaller than the file resolution.
+    unsigned int mFrameWidth;
+    unsigned int mFrameHeight;
 
     double mFrameRate;
     float mSpeedModifier;
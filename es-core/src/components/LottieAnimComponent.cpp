@@ -15,15 +15,17 @@
 #include "Window.h"
 #include "resources/ResourceManager.h"
 
+// Number of frames that are rasterized ahead of time in parallel by the rlottie render threads.
+#define RENDER_AHEAD_FRAMES 3
+
 LottieAnimComponent::LottieAnimComponent()
     : mRenderer {Renderer::getInstance()}
     , mTargetSize {0.0f, 0.0f}
+    , mCachedAnimation {nullptr}
     , mCacheFrames {true}
     , mMaxCacheSize {0}
-    , mCacheSize {0}
     , mFrameSize {0}
     , mAnimation {nullptr}
-    , mSurface {nullptr}
     , mStartDirection {"normal"}
     , mTotalFrames {0}
     , mFrameNum {0}
@@ -34,6 +36,7 @@ LottieAnimComponent::LottieAnimComponent()
     , mLastRenderedFrame {-1}
     , mSkippedFrames {0}
     , mHoldFrame {true}
+    , mWaitingForFrame {false}
     , mPause {false}
     , mExternalPause {false}
     , mAlternate {false}
@@ -66,26 +69,12 @@ LottieAnimComponent::LottieAnimComponent()
     setZIndex(35.0f);
 }
 
-LottieAnimComponent::~LottieAnimComponent()
-{
-    // This is required as rlottie could otherwise crash on application shutdown.
-    if (mFuture.valid())
-        mFuture.get();
-
-    mTotalFrameCache -= mCacheSize;
-}
+LottieAnimComponent::~LottieAnimComponent() { releaseAnimation(); }
 
 void LottieAnimComponent::setAnimation(const std::string& path)
 {
-    if (mAnimation != nullptr) {
-        if (mFuture.valid())
-            mFuture.get();
-        mSurface.reset();
-        mAnimation.reset();
-        mPictureRGBA.clear();
-        mCacheSize = 0;
-        mLastRenderedFrame = -1;
-    }
+    if (mAnimation != nullptr)
+        releaseAnimation();
 
     mPath = path;
 
@@ -104,20 +93,14 @@ void LottieAnimComponent::setAnimation(const std::string& path)
         return;
     }
 
-    ResourceData animData {ResourceManager::getInstance().getFileData(mPath)};
-    std::string cache;
-
+    ResourceData animData {ResourceManager::getInstance().getFileData(mPath, true)};
+    const std::string animJSON {reinterpret_cast<char*>(animData.ptr.get()), animData.length};
     // If in debug mode, then disable the rlottie caching so that animations can be replaced on
-    // the fly using Ctrl+r reloads.
-    if (Settings::getInstance()->getBool("Debug")) {
-        mAnimation = rlottie::Animation::loadFromData(
-            std::string(reinterpret_cast<char*>(animData.ptr.get()), animData.length), cache, "",
-            false);
-    }
-    else {
-        mAnimation = rlottie::Animation::loadFromData(
-            std::string(reinterpret_cast<char*>(animData.ptr.get()), animData.length), cache);
-    }
+    // the fly using Ctrl+r reloads. Otherwise the parsed model is shared by all animation objects
+    // for the file, including the ones used by the render slots.
+    const bool modelCaching {!Settings::getInstance()->getBool("Debug")};
+
+    mAnimation = rlottie::Animation::loadFromData(animJSON, mPath, "", modelCaching);
 
     if (mAnimation == nullptr) {
         LOG(LogError) << "Couldn't parse Lottie animation file \"" << mPath << "\"";
@@ -182,15 +165,25 @@ void LottieAnimComponent::setAnimation(const std::string& path)
         mTargetSize = mSize;
 
     mPictureRGBA.resize(width * height * 4);
-    mSurface = std::make_unique<rlottie::Surface>(reinterpret_cast<uint32_t*>(&mPictureRGBA[0]),
-                                                  width, height, width * sizeof(uint32_t));
-
-    if (mSurface == nullptr) {
-        LOG(LogError) << "Couldn't create Lottie surface for file \"" << mPath << "\"";
-        mAnimation.reset();
-        return;
+    mRenderSlots.resize(RENDER_AHEAD_FRAMES);
+
+    for (auto& slot : mRenderSlots) {
+        slot.animation = rlottie::Animation::loadFromData(animJSON, mPath, "", modelCaching);
+        if (slot.animation == nullptr) {
+            LOG(LogError) << "Couldn't parse Lottie animation file \"" << mPath << "\"";
+            mRenderSlots.clear();
+            mAnimation.reset();
+            return;
+        }
+        slot.pixels.resize(width * height * 4);
+        slot.surface = std::make_unique<rlottie::Surface>(
+            reinterpret_cast<uint32_t*>(&slot.pixels[0]), width, height, width * sizeof(uint32_t));
     }
 
+    mFrameCacheKey = {mPath, Utils::FileSystem::getFileModificationTime(mPath), width, height};
+    mCachedAnimation = &sFrameCache[mFrameCacheKey];
+    ++mCachedAnimation->users;
+
     // Some statistics for the file.
     mTotalFrames = mAnimation->totalFrame();
     mFrameRate = mAnimation->frameRate();
@@ -225,6 +218,9 @@ void LottieAnimComponent::setAnimation(const std::string& path)
         LOG(LogDebug) << "LottieAnimComponent::setAnimation(): Per file maximum cache size: "
                       << mMaxCacheSize << " bytes (" << std::fixed << std::setprecision(1)
                       << static_cast<double>(mMaxCacheSize) / 1024.0 / 1024.0 << " MiB)";
+        LOG(LogDebug) << "LottieAnimComponent::setAnimation(): Shared frame cache size: "
+                      << mTotalFrameCache << " bytes (" << std::fixed << std::setprecision(1)
+                      << static_cast<double>(mTotalFrameCache) / 1024.0 / 1024.0 << " MiB)";
     }
 
     mAnimationStartTime = std::chrono::system_clock::now();
@@ -237,12 +233,11 @@ void LottieAnimComponent::resetComponent()
     mTimeAccumulator = 0;
     mDirection = mStartDirection;
     mFrameNum = mStartDirection == "reverse" ? mTotalFrames - 1 : 0;
+    mWaitingForFrame = false;
 
     if (mAnimation != nullptr) {
-        if (mFuture.valid())
-            mFuture.get();
-        mFuture = mAnimation->render(mFrameNum, *mSurface, false);
-        mLastRenderedFrame = static_cast<int>(mFrameNum);
+        collectRenderedFrames();
+        scheduleFrames();
     }
 }
 
@@ -458,8 +453,20 @@ void LottieAnimComponent::render(const glm::mat4& parentTrans)
 
     // This is necessary as there may otherwise be no texture to render when paused.
     if ((mExternalPause || mPause) && mTexture->getSize().x == 0.0f) {
-        mTexture->initFromPixels(&mPictureRGBA.at(0), static_cast<size_t>(mSize.x),
-                                 static_cast<size_t>(mSize.y));
+        const size_t frameNum {std::min(mFrameNum, mTotalFrames - 1)};
+        auto it = mCachedAnimation->frames.find(frameNum);
+        if (it != mCachedAnimation->frames.end()) {
+            mTexture->initFromPixels(&it->second.at(0), static_cast<size_t>(mSize.x),
+                                     static_cast<size_t>(mSize.y));
+        }
+        else {
+            rlottie::Surface surface {reinterpret_cast<uint32_t*>(&mPictureRGBA[0]),
+                                      static_cast<size_t>(mSize.x), static_cast<size_t>(mSize.y),
+                                      static_cast<size_t>(mSize.x) * sizeof(uint32_t)};
+            mAnimation->renderSync(frameNum, surface, false);
+            mTexture->initFromPixels(&mPictureRGBA.at(0), static_cast<size_t>(mSize.x),
+                                     static_cast<size_t>(mSize.y));
+        }
     }
 
     bool doRender {true};
@@ -512,64 +519,47 @@ void LottieAnimComponent::render(const glm::mat4& parentTrans)
                 mAnimationStartTime = std::chrono::system_clock::now();
         }
 
-        bool renderNextFrame {false};
-
-        if (mFuture.valid()) {
-            if (mFuture.wait_for(std::chrono::milliseconds(1)) == std::future_status::ready) {
-                mFuture.get();
-                // Cache frame if caching is enabled and we're not exceeding either the per-file
-                // max cache size or the total cache size. Note that this is completely unrelated
-                // to the texture caching used for images.
-                if (mCacheFrames && mLastRenderedFrame != -1 &&
-                    mFrameCache.find(mLastRenderedFrame) == mFrameCache.end()) {
-                    size_t newCacheSize {mCacheSize + mFrameSize};
-                    if (newCacheSize < mMaxCacheSize &&
-                        mTotalFrameCache + mFrameSize < mMaxTotalFrameCache) {
-                        mFrameCache[mLastRenderedFrame] = mPictureRGBA;
-                        mCacheSize += mFrameSize;
-                        mTotalFrameCache += mFrameSize;
-                        mLastRenderedFrame = -1;
+        collectRenderedFrames();
+
+        // If the frame was not ready when it was due, then show it as soon as it's been rendered.
+        if (mFrameNum < mTotalFrames && (!mHoldFrame || mWaitingForFrame)) {
+            const uint8_t* pixels {nullptr};
+            auto it = mCachedAnimation->frames.find(mFrameNum);
+
+            if (it != mCachedAnimation->frames.end()) {
+                pixels = &it->second.at(0);
+                ++sFrameCacheHits;
+            }
+            else {
+                for (auto& slot : mRenderSlots) {
+                    if (slot.frameNum == static_cast<int>(mFrameNum) && !slot.future.valid()) {
+                        cacheFrame(mFrameNum, slot.pixels);
+                        pixels = &slot.pixels.at(0);
+                        // The pixels remain valid until the next frame is scheduled below.
+                        slot.frameNum = -1;
+                        ++sFrameCacheMisses;
+                        break;
                     }
                 }
+            }
 
-                mTexture->initFromPixels(&mPictureRGBA.at(0), static_cast<size_t>(mSize.x),
+            if (pixels != nullptr) {
+                mTexture->initFromPixels(pixels, static_cast<size_t>(mSize.x),
                                          static_cast<size_t>(mSize.y));
+                mLastRenderedFrame = static_cast<int>(mFrameNum);
+                mWaitingForFrame = false;
 
                 if (mDirection == "reverse")
                     --mFrameNum;
                 else
                     ++mFrameNum;
-
-                if (mDirection == "reverse" && mFrameNum == 0)
-                    renderNextFrame = false;
-                else if (mFrameNum == mTotalFrames)
-                    renderNextFrame = false;
-                else
-                    renderNextFrame = true;
-            }
-        }
-        else {
-            if (mFrameCache.find(mFrameNum) != mFrameCache.end()) {
-                if (!mHoldFrame) {
-                    mTexture->initFromPixels(&mFrameCache[mFrameNum][0],
-                                             static_cast<size_t>(mSize.x),
-                                             static_cast<size_t>(mSize.y));
-
-                    if (mDirection == "reverse")
-                        --mFrameNum;
-                    else
-                        ++mFrameNum;
-                }
             }
             else {
-                renderNextFrame = true;
+                mWaitingForFrame = true;
             }
         }
 
-        if (renderNextFrame && !mHoldFrame) {
-            mFuture = mAnimation->render(mFrameNum, *mSurface, false);
-            mLastRenderedFrame = static_cast<int>(mFrameNum);
-        }
+        scheduleFrames();
     }
 
     mRenderer->setMatrix(trans);
@@ -618,3 +608,96 @@ void LottieAnimComponent::render(const glm::mat4& parentTrans)
 
     mHoldFrame = true;
 }
+
+void LottieAnimComponent::releaseAnimation()
+{
+    // This is required as rlottie could otherwise crash on application shutdown.
+    for (auto& slot : mRenderSlots) {
+        if (slot.future.valid())
+            slot.future.get();
+    }
+
+    mRenderSlots.clear();
+    mAnimation.reset();
+    mPictureRGBA.clear();
+    mLastRenderedFrame = -1;
+    mWaitingForFrame = false;
+
+    if (mCachedAnimation != nullptr) {
+        // Drop the cached frames once the last component using the animation is gone.
+        if (--mCachedAnimation->users == 0) {
+            mTotalFrameCache -= mCachedAnimation->cacheSize;
+            sFrameCache.erase(mFrameCacheKey);
+        }
+        mCachedAnimation = nullptr;
+    }
+}
+
+void LottieAnimComponent::collectRenderedFrames()
+{
+    for (auto& slot : mRenderSlots) {
+        if (slot.frameNum == -1)
+            continue;
+
+        if (slot.future.valid()) {
+            if (slot.future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
+                continue;
+            slot.future.get();
+        }
+
+        // Frames skipped due to frame skipping or a changed direction are still worth caching
+        // as the rendering work has already been done.
+        if (!isUpcomingFrame(static_cast<size_t>(slot.frameNum))) {
+            cacheFrame(static_cast<size_t>(slot.frameNum), slot.pixels);
+            slot.frameNum = -1;
+        }
+    }
+}
+
+void LottieAnimComponent::scheduleFrames()
+{
+    for (size_t i {0}; i < mRenderSlots.size(); ++i) {
+        // Frame numbers below zero wrap around and are thereby excluded as well.
+        const size_t frameNum {mDirection == "reverse" ? mFrameNum - i : mFrameNum + i};
+        if (frameNum >= mTotalFrames)
+            break;
+
+        if (mCachedAnimation->frames.find(frameNum) != mCachedAnimation->frames.end())
+            continue;
+
+        if (std::find_if(mRenderSlots.cbegin(), mRenderSlots.cend(), [frameNum](auto& slot) {
+                return slot.frameNum == static_cast<int>(frameNum);
+            }) != mRenderSlots.cend())
+            continue;
+
+        auto freeSlot = std::find_if(mRenderSlots.begin(), mRenderSlots.end(),
+                                     [](auto& slot) { return slot.frameNum == -1; });
+        if (freeSlot == mRenderSlots.end())
+            break;
+
+        freeSlot->frameNum = static_cast<int>(frameNum);
+        freeSlot->future = freeSlot->animation->render(frameNum, *freeSlot->surface, false);
+    }
+}
+
+void LottieAnimComponent::cacheFrame(const size_t frameNum, const std::vector<uint8_t>& pixels)
+{
+    // Cache frame if caching is enabled and we're not exceeding either the per-file max cache
+    // size or the total cache size. Note that this is completely unrelated to the texture
+    // caching used for images.
+    if (!mCacheFrames || mCachedAnimation->frames.find(frameNum) != mCachedAnimation->frames.end())
+        return;
+
+    if (mCachedAnimation->cacheSize + mFrameSize < mMaxCacheSize &&
+        mTotalFrameCache + mFrameSize < mMaxTotalFrameCache) {
+        mCachedAnimation->frames[frameNum] = pixels;
+        mCachedAnimation->cacheSize += mFrameSize;
+        mTotalFrameCache += mFrameSize;
+    }
+}
+
+bool LottieAnimComponent::isUpcomingFrame(const size_t frameNum) const
+{
+    const size_t distance {mDirection == "reverse" ? mFrameNum - frameNum : frameNum - mFrameNum};
+    return distance < mRenderSlots.size();
+}
@@ -23,6 +23,8 @@
 
 #include <chrono>
 #include <future>
+#include <map>
+#include <tuple>
 #include <unordered_map>
 
 class LottieAnimComponent : public GuiComponent
@@ -49,26 +51,70 @@ public:
 
     void update(int deltaTime) override;
 
+    struct FrameCacheStatistics {
+        unsigned long hits;
+        unsigned long misses;
+        size_t bytes;
+    };
+
+    // Frame cache counters for all Lottie animations combined.
+    static const FrameCacheStatistics getFrameCacheStatistics()
+    {
+        return FrameCacheStatistics {sFrameCacheHits, sFrameCacheMisses, mTotalFrameCache};
+    }
+
 private:
     void render(const glm::mat4& parentTrans) override;
 
+    // Frames are rasterized ahead of time in parallel, and as a single rlottie::Animation can
+    // only render one frame at a time each slot has its own animation sharing the parsed model.
+    struct RenderSlot {
+        std::unique_ptr<rlottie::Animation> animation;
+        std::unique_ptr<rlottie::Surface> surface;
+        std::vector<uint8_t> pixels;
+        std::future<rlottie::Surface> future;
+        // Set to -1 if the slot is unused.
+        int frameNum {-1};
+    };
+
+    // Path, file modification time, width and height.
+    using FrameCacheKeyType = std::tuple<std::string, long long, size_t, size_t>;
+    struct CachedAnimation {
+        std::unordered_map<size_t, std::vector<uint8_t>> frames;
+        size_t cacheSize;
+        int users;
+    };
+
+    void releaseAnimation();
+    // Checks for completed frames and frees the slots of frames which are no longer upcoming.
+    void collectRenderedFrames();
+    // Starts rendering the upcoming frames which are not already cached or being rendered.
+    void scheduleFrames();
+    // Adds the frame to the shared cache unless this would exceed the cache size limits.
+    void cacheFrame(const size_t frameNum, const std::vector<uint8_t>& pixels);
+    bool isUpcomingFrame(const size_t frameNum) const;
+
     Renderer* mRenderer;
     glm::vec2 mTargetSize;
     std::shared_ptr<TextureResource> mTexture;
     std::vector<uint8_t> mPictureRGBA;
-    std::unordered_map<size_t, std::vector<uint8_t>> mFrameCache;
+    // Rendered frames shared by all instances, so the same animation at the same size used by
+    // multiple elements is only rasterized once.
+    static inline std::map<FrameCacheKeyType, CachedAnimation> sFrameCache;
+    static inline unsigned long sFrameCacheHits {0};
+    static inline unsigned long sFrameCacheMisses {0};
     // Set a 1024 MiB total Lottie animation cache as default.
     static inline size_t mMaxTotalFrameCache {1024 * 1024 * 1024};
     static inline size_t mTotalFrameCache;
+    FrameCacheKeyType mFrameCacheKey;
+    CachedAnimation* mCachedAnimation;
     bool mCacheFrames;
     size_t mMaxCacheSize;
-    size_t mCacheSize;
     size_t mFrameSize;
 
     std::chrono::time_point<std::chrono::system_clock> mAnimationStartTime;
     std::unique_ptr<rlottie::Animation> mAnimation;
-    std::unique_ptr<rlottie::Surface> mSurface;
-    std::future<rlottie::Surface> mFuture;
+    std::vector<RenderSlot> mRenderSlots;
     std::string mPath;
     std::string mStartDirection;
     std::string mDirection;
@@ -83,6 +129,7 @@ private:
     int mSkippedFrames;
 
     bool mHoldFrame;
+    bool mWaitingForFrame;
     bool mPause;
     bool mExternalPause;
     bool mAlternate;
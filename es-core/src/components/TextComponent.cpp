@@ -237,6 +237,13 @@ void TextComponent::render(const glm::mat4& parentTrans)
         mSize.y == 0.0f)
         return;
 
+    // The glyph atlas pages used by the text cache may have been evicted since it was built.
+    if (!mTextCache->isValid()) {
+        onTextChanged();
+        if (mTextCache == nullptr)
+            return;
+    }
+
     glm::mat4 trans {parentTrans * getTransform()};
     mRenderer->setMatrix(trans);
 
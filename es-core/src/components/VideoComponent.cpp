@@ -39,6 +39,7 @@ VideoComponent::VideoComponent()
     , mIsPlaying {false}
     , mIsActuallyPlaying {false}
     , mPaused {false}
+    , mPrefetched {false}
     , mMediaViewerMode {false}
     , mScreensaverMode {false}
     , mTargetIsMax {false}
@@ -458,7 +459,8 @@ void VideoComponent::startVideoPlayer()
 {
     mPlayCount = 0;
 
-    if (mIsPlaying)
+    // A prefetched player keeps its stream and starts playing on its next update.
+    if (mIsPlaying && !mPrefetched)
         stopVideoPlayer();
 
     if (mConfig.showStaticImageDelay && mConfig.startDelay != 0 && mStaticImagePath != "") {
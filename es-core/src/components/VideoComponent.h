@@ -85,6 +85,10 @@ public:
     void startVideoPlayer();
     virtual void stopVideoPlayer(bool muteAudio = true) {}
     virtual void pauseVideoPlayer() {}
+    // Opens the video stream and decodes the first frames in the background without starting
+    // playback. This is called repeatedly instead of update() until the video should start
+    // playing, at which point update() is called as usual.
+    virtual void prefetchVideoPlayer() {}
 
     // Needed on Android to reset the static image delay timer on activity resume.
     void resetVideoPlayerTimer() { mStartTime = SDL_GetTicks() + mConfig.startDelay; }
@@ -136,6 +140,8 @@ protected:
     std::atomic<bool> mIsPlaying;
     std::atomic<bool> mIsActuallyPlaying;
     std::atomic<bool> mPaused;
+    // Set for a player started via prefetchVideoPlayer() until its first regular update.
+    bool mPrefetched;
     bool mMediaViewerMode;
     bool mScreensaverMode;
     bool mTargetIsMax;
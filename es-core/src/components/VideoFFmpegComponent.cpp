@@ -10,6 +10,7 @@
 
 #include "AudioManager.h"
 #include "Settings.h"
+#include "VideoWorkerPool.h"
 #include "Window.h"
 #include "resources/TextureResource.h"
 #include "utils/StringUtil.h"
@@ -17,10 +18,19 @@
 #include <SDL2/SDL.h>
 
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <limits>
 
 #define DEBUG_VIDEO false
 
+// Number of frames in the video frame ring in addition to the target queue size. Two of these
+// are reserved for the frame that is currently output and the frame that is being rendered.
+// The ring grows beyond this if the reader gets further ahead, e.g. when filling the audio queue.
+#define VIDEO_FRAME_RING_MARGIN 6
+// The memory cap in MiB for the first frame cache.
+#define FIRST_FRAME_CACHE_SIZE 64
+
 #if LIBAVUTIL_VERSION_MAJOR >= 58 ||                                                               \
     (LIBAVUTIL_VERSION_MAJOR >= 57 && LIBAVUTIL_VERSION_MINOR >= 28)
 // FFmpeg 5.1 and above.
@@ -30,8 +40,22 @@
 #endif
 
 VideoFFmpegComponent::VideoFFmpegComponent()
-    : mBlackFrameOffset {0.0f, 0.0f}
-    , mFrameProcessingThread {nullptr}
+    : mPlaneTextures {0, 0, 0}
+    , mPlaneTextureSize {0, 0}
+    , mPlaneShaderFlags {0}
+    , mBlackFrameOffset {0.0f, 0.0f}
+    , mDecodeSize {0, 0}
+    , mVideoWorkerID {0}
+    , mFrameProcessingStarted {false}
+    , mVideoFilter {false}
+    , mAudioFilter {false}
+    , mStreamSetupThread {nullptr}
+    , mStreamSetupDone {false}
+    , mStreamSetupSucceeded {false}
+    , mStreamState {StreamState::STOPPED}
+    , mCachedFrameShown {false}
+    , mFirstFrameCached {false}
+    , mPlayerCounted {false}
     , mFormatContext {nullptr}
     , mVideoStream {nullptr}
     , mAudioStream {nullptr}
@@ -51,6 +75,9 @@ VideoFFmpegComponent::VideoFFmpegComponent()
     , mAFilterGraph {nullptr}
     , mAFilterInputs {nullptr}
     , mAFilterOutputs {nullptr}
+    , mVideoFrameQueueHead {0}
+    , mVideoFrameQueueSize {0}
+    , mRenderingFrameIndex {-1}
     , mVideoTargetQueueSize {0}
     , mAudioTargetQueueSize {0}
     , mVideoTimeBase {0.0l}
@@ -60,6 +87,8 @@ VideoFFmpegComponent::VideoFFmpegComponent()
     , mDecodedFrame {false}
     , mReadAllFrames {false}
     , mEndOfVideo {false}
+    , mResyncStreams {false}
+    , mGPUColorConversion {false}
 {
 }
 
@@ -186,7 +215,7 @@ void VideoFFmpegComponent::render(const glm::mat4& parentTrans)
     glm::mat4 trans {parentTrans * getTransform()};
     GuiComponent::renderChildren(trans);
 
-    if (mIsPlaying && mFormatContext) {
+    if (mIsPlaying && (mStreamState == StreamState::READY || mCachedFrameShown)) {
         Renderer::Vertex vertices[4];
 
         if (Settings::getInstance()->getBool("DebugImage")) {
@@ -210,7 +239,7 @@ void VideoFFmpegComponent::render(const glm::mat4& parentTrans)
         mRenderer->setMatrix(trans);
 
         // This is needed to avoid a slight gap before the video starts playing.
-        if (!mDecodedFrame)
+        if (!mDecodedFrame && !mCachedFrameShown)
             return;
 
         const float paddingComp {mLinePaddingComp};
@@ -263,42 +292,55 @@ void VideoFFmpegComponent::render(const glm::mat4& parentTrans)
 
         std::unique_lock<std::mutex> pictureLock {mPictureMutex};
 
-        if (!mOutputPicture.hasBeenRendered) {
-            // Move the contents of mOutputPicture to a temporary vector in order to call
-            // initFromPixels() only after the mutex unlock. This significantly reduces the
-            // lock waits in outputFrames().
-            size_t pictureSize {mOutputPicture.pictureRGBA.size()};
-            std::vector<uint8_t> tempPictureRGBA;
-            int pictureWidth {0};
-            int pictureHeight {0};
-
-            if (pictureSize > 0) {
-                tempPictureRGBA.insert(tempPictureRGBA.begin(),
-                                       std::make_move_iterator(mOutputPicture.pictureRGBA.begin()),
-                                       std::make_move_iterator(mOutputPicture.pictureRGBA.end()));
-
-                mOutputPicture.pictureRGBA.erase(mOutputPicture.pictureRGBA.begin(),
-                                                 mOutputPicture.pictureRGBA.end());
+        if (!mOutputPicture.hasBeenRendered && mOutputPicture.frameIndex != -1) {
+            // Mark the frame as being rendered so that initFromPixels() can be called after
+            // the mutex unlock without the frame getting reused by the processing thread.
+            // This significantly reduces the lock waits in outputFrames().
+            const int frameIndex {mOutputPicture.frameIndex};
+            mRenderingFrameIndex = frameIndex;
+            mOutputPicture.hasBeenRendered = true;
+            // The ring may grow while unlocked, but this doesn't invalidate the reference.
+            const VideoFrame& frame {mVideoFrameRing[frameIndex]};
+            pictureLock.unlock();
 
-                pictureWidth = mOutputPicture.width;
-                pictureHeight = mOutputPicture.height;
+            // Build a texture for the video frame.
+            if (mGPUColorConversion)
+                uploadVideoFramePlanes(frame);
+            else
+                mTexture->initFromPixels(frame.frameData.data(), frame.width, frame.height);
+            ++sVideoFramesCopied;
 
-                mOutputPicture.hasBeenRendered = true;
+            if (!mFirstFrameCached) {
+                cacheFirstFrame(frame);
+                mFirstFrameCached = true;
             }
 
+            pictureLock.lock();
+            mRenderingFrameIndex = -1;
+            if (mOutputPicture.frameIndex != frameIndex)
+                releaseVideoFrame(frameIndex);
             pictureLock.unlock();
-
-            if (pictureSize > 0) {
-                // Build a texture for the video frame.
-                mTexture->initFromPixels(&tempPictureRGBA.at(0), pictureWidth, pictureHeight);
-            }
         }
         else {
             pictureLock.unlock();
         }
 
-        if (mTexture != nullptr)
+        if (mGPUColorConversion) {
+            // The plane textures are created when the first frame is uploaded, and binding
+            // them before that would render a green frame. Only the black frame is shown until
+            // then, the same as when no frame has been decoded yet.
+            if (mPlaneTextures[0] == 0)
+                return;
+            // Bind texture unit 0 last as that is expected to be the active unit.
+            mRenderer->bindTexture(mPlaneTextures[2], 2);
+            mRenderer->bindTexture(mPlaneTextures[1], 1);
+            mRenderer->bindTexture(mPlaneTextures[0], 0);
+            vertices->shaderFlags = vertices->shaderFlags | Renderer::ShaderFlags::YUV_VIDEO |
+                                    mPlaneShaderFlags;
+        }
+        else if (mTexture != nullptr) {
             mTexture->bind(0);
+        }
 
         // Render scanlines if this option is enabled. However, if this is the media viewer
         // or the video screensaver, then skip this as the scanline rendering is then handled
@@ -322,7 +364,7 @@ void VideoFFmpegComponent::render(const glm::mat4& parentTrans)
 
 void VideoFFmpegComponent::updatePlayer()
 {
-    if (mPaused || !mFormatContext)
+    if (mPaused || mStreamState != StreamState::READY)
         return;
 
     const long double deltaTime {
@@ -338,13 +380,12 @@ void VideoFFmpegComponent::updatePlayer()
     // The frame queues are emptied as well and the audio stream is cleared in order to
     // re-synchronize the streams. This is neeeded as some platforms like Android keep processing
     // the audio buffers before suspending the application (i.e. after rendering has stopped).
+    // The frame queues are only accessed by the frame processing thread, so they are emptied
+    // there on the next call to frameProcessing().
     if (deltaTime > 1.2) {
         AudioManager::getInstance().clearStream();
         mTimeReference = std::chrono::high_resolution_clock::now();
-        while (mAudioFrameQueue.size() > 1 && mVideoFrameQueue.size() > 1 &&
-               mAudioFrameQueue.front().pts > mVideoFrameQueue.front().pts) {
-            mVideoFrameQueue.pop();
-        }
+        mResyncStreams = true;
         return;
     }
 
@@ -363,41 +404,74 @@ void VideoFFmpegComponent::updatePlayer()
 
     audioLock.unlock();
 
-    if (!mFrameProcessingThread) {
+    // Fullscreen videos get the highest priority, followed by the largest videos on screen
+    // as these are normally the ones that have focus.
+    const float priority {(mScreensaverMode || mMediaViewerMode) ?
+                              std::numeric_limits<float>::max() :
+                              mSize.x * mSize.y};
+
+    if (mVideoWorkerID == 0) {
         AudioManager::getInstance().unmuteStream();
-        mFrameProcessingThread =
-            std::make_unique<std::thread>(&VideoFFmpegComponent::frameProcessing, this);
+        mVideoWorkerID = VideoWorkerPool::getInstance().addPlayer(
+            std::bind(&VideoFFmpegComponent::frameProcessing, this), priority);
+    }
+    else {
+        // A prefetched video starts playing on its first regular update.
+        if (mPrefetched)
+            AudioManager::getInstance().unmuteStream();
+        VideoWorkerPool::getInstance().setPriority(mVideoWorkerID, priority);
+    }
+
+    mPrefetched = false;
+
+    // Prefetched players are not counted until they start playing.
+    if (!mPlayerCounted) {
+        mWindow->increaseVideoPlayerCount();
+        mPlayerCounted = true;
     }
 }
 
 void VideoFFmpegComponent::frameProcessing()
 {
-    mWindow->increaseVideoPlayerCount();
+    if (!mFrameProcessingStarted) {
+        mVideoFilter = setupVideoFilters();
 
-    bool videoFilter {false};
-    bool audioFilter {false};
+        if (mAudioCodecContext)
+            mAudioFilter = setupAudioFilters();
 
-    videoFilter = setupVideoFilters();
+        mFrameProcessingStarted = true;
+    }
 
-    if (mAudioCodecContext)
-        audioFilter = setupAudioFilters();
+    if (!mIsPlaying || mPaused || !mVideoFilter || (mAudioCodecContext && !mAudioFilter))
+        return;
 
-    while (mIsPlaying && !mPaused && videoFilter && (!mAudioCodecContext || audioFilter)) {
-        readFrames();
-        if (!mIsPlaying)
-            break;
+    if (mResyncStreams.exchange(false)) {
+        // Drop the video frames that are behind the queued audio, see updatePlayer().
+        std::unique_lock<std::mutex> pictureLock {mPictureMutex};
+        while (mAudioFrameQueue.size() > 1 && mVideoFrameQueueSize > 1 &&
+               mAudioFrameQueue.front().pts >
+                   mVideoFrameRing[mVideoFrameQueue[mVideoFrameQueueHead]].pts) {
+            releaseVideoFrame(dequeueVideoFrame());
+        }
+    }
 
-        getProcessedFrames();
-        if (!mIsPlaying)
-            break;
+    readFrames();
+    if (!mIsPlaying)
+        return;
 
-        outputFrames();
+    getProcessedFrames();
+    if (!mIsPlaying)
+        return;
 
-        // This 1 ms wait makes sure that the thread does not consume all available CPU cycles.
-        SDL_Delay(1);
-    }
+    outputFrames();
+}
+
+void VideoFFmpegComponent::finishFrameProcessing()
+{
+    if (!mFrameProcessingStarted)
+        return;
 
-    if (videoFilter) {
+    if (mVideoFilter) {
         avfilter_inout_free(&mVFilterInputs);
         avfilter_inout_free(&mVFilterOutputs);
         avfilter_free(mVBufferSrcContext);
@@ -407,7 +481,7 @@ void VideoFFmpegComponent::frameProcessing()
         mVBufferSinkContext = nullptr;
     }
 
-    if (audioFilter) {
+    if (mAudioFilter) {
         avfilter_inout_free(&mAFilterInputs);
         avfilter_inout_free(&mAFilterOutputs);
         avfilter_free(mABufferSrcContext);
@@ -417,7 +491,9 @@ void VideoFFmpegComponent::frameProcessing()
         mABufferSinkContext = nullptr;
     }
 
-    mWindow->decreaseVideoPlayerCount();
+    mVideoFilter = false;
+    mAudioFilter = false;
+    mFrameProcessingStarted = false;
 }
 
 bool VideoFFmpegComponent::setupVideoFilters()
@@ -434,9 +510,9 @@ bool VideoFFmpegComponent::setupVideoFilters()
         return false;
     }
 
-    // Limit the libavfilter video processing to two additional threads.
-    // Not sure why the actual thread count is one less than specified.
-    mVFilterGraph->nb_threads = 3;
+    // Limit the libavfilter video processing to at most two additional threads, depending on
+    // the video thread budget. Not sure why the actual thread count is one less than specified.
+    mVFilterGraph->nb_threads = VideoWorkerPool::getInstance().getFilterThreadCount(false);
 
     const AVFilter* bufferSrc {avfilter_get_by_name("buffer")};
     if (!bufferSrc) {
@@ -510,10 +586,24 @@ bool VideoFFmpegComponent::setupVideoFilters()
 
     std::string filterDescription;
 
+    // Scale the frames to the size they will be displayed at, which lowers the CPU usage for
+    // the pixel format conversion as well as the texture upload bandwidth. This will also
+    // take care of the padding when the width is not in increments of 16 pixels.
+    const bool scaleFrames {mDecodeSize.x != mVideoCodecContext->width ||
+                            mDecodeSize.y != mVideoCodecContext->height};
+
+    if (scaleFrames) {
+        filterDescription.append("scale=width=")
+            .append(std::to_string(mDecodeSize.x))
+            .append(":height=")
+            .append(std::to_string(mDecodeSize.y))
+            .append(":flags=bilinear,");
+    }
+
     // Whether to upscale the frame rate to 60 FPS.
     if (Settings::getInstance()->getBool("VideoUpscaleFrameRate")) {
 
-        if (modulo > 0) {
+        if (modulo > 0 && !scaleFrames) {
             filterDescription.append("scale=width=")
                 .append(std::to_string(width))
                 .append(":height=")
@@ -539,8 +629,12 @@ bool VideoFFmpegComponent::setupVideoFilters()
         // }
     }
 
+    // If the pixel format conversion is done by the shader then the frames are kept in planar
+    // YUV format. This is normally the native decoder output so no conversion takes place,
+    // except for hardware decoded frames which are NV12 and need to be de-interleaved.
     filterDescription.append("format=pix_fmts=")
-        .append(std::string(av_get_pix_fmt_name(AV_PIX_FMT_BGRA)));
+        .append(std::string(
+            av_get_pix_fmt_name(mGPUColorConversion ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_BGRA)));
 
     returnValue = avfilter_graph_parse_ptr(mVFilterGraph, filterDescription.c_str(),
                                            &mVFilterInputs, &mVFilterOutputs, nullptr);
@@ -585,9 +679,9 @@ bool VideoFFmpegComponent::setupAudioFilters()
         return false;
     }
 
-    // Limit the libavfilter audio processing to one additional thread.
-    // Not sure why the actual thread count is one less than specified.
-    mAFilterGraph->nb_threads = 2;
+    // Limit the libavfilter audio processing to at most one additional thread, depending on
+    // the video thread budget. Not sure why the actual thread count is one less than specified.
+    mAFilterGraph->nb_threads = VideoWorkerPool::getInstance().getFilterThreadCount(true);
 
     const AVFilter* bufferSrc {avfilter_get_by_name("abuffer")};
     if (!bufferSrc) {
@@ -697,7 +791,7 @@ void VideoFFmpegComponent::readFrames()
     // It's not clear if this can actually happen in practise, but in theory we could
     // continue to load frames indefinitely and run out of memory if invalid PTS values
     // are presented by FFmpeg.
-    if (mVideoFrameQueue.size() > 300 || mAudioFrameQueue.size() > 600)
+    if (mVideoFrameQueueSize > 300 || mAudioFrameQueue.size() > 600)
         return;
 
     int readLoops {1};
@@ -715,7 +809,7 @@ void VideoFFmpegComponent::readFrames()
 
     if (mVideoCodecContext && mFormatContext) {
         for (int i {0}; i < readLoops; ++i) {
-            if (static_cast<int>(mVideoFrameQueue.size()) < mVideoTargetQueueSize ||
+            if (static_cast<int>(mVideoFrameQueueSize) < mVideoTargetQueueSize ||
                 (mAudioStreamIndex >= 0 &&
                  static_cast<int>(mAudioFrameQueue.size()) < mAudioTargetQueueSize)) {
                 while ((readFrameReturn = av_read_frame(mFormatContext, mPacket)) >= 0) {
@@ -735,6 +829,7 @@ void VideoFFmpegComponent::readFrames()
                                 }
                                 else {
                                     ++mVideoFrameDroppedCount;
+                                    ++sVideoFramesDropped;
                                 }
                             }
                             else {
@@ -784,6 +879,7 @@ void VideoFFmpegComponent::readFrames()
                                 }
                                 else {
                                     ++mVideoFrameDroppedCount;
+                                    ++sVideoFramesDropped;
                                 }
                             }
 
@@ -842,26 +938,75 @@ void VideoFFmpegComponent::getProcessedFrames()
     while (av_buffersink_get_frame(mVBufferSinkContext, mVideoFrameResampled) >= 0) {
 
         // Save frame into the queue for later processing.
-        VideoFrame currFrame;
-
-        // This is likely unnecessary as AV_PIX_FMT_RGBA always uses 4 bytes per pixel.
-        // const int bytesPerPixel {
-        //    av_get_padded_bits_per_pixel(av_pix_fmt_desc_get(AV_PIX_FMT_RGBA)) / 8};
-        const int bytesPerPixel {4};
-        const int width {mVideoFrameResampled->linesize[0] / bytesPerPixel};
-
-        // For performance reasons the linesize value may padded to a larger size than the
-        // usable data. This seems to happen mostly (only?) on Windows. If this occurs we
-        // need to compensate for this when calculating the vertices in render().
-        if (width != mVideoFrameResampled->width && width > 0) {
-            const float linePaddingComp {static_cast<float>(width - mVideoFrameResampled->width) /
-                                         static_cast<float>(width)};
-            if (linePaddingComp != 0.0f)
-                mLinePaddingComp = linePaddingComp;
+        const int frameIndex {acquireVideoFrame()};
+        VideoFrame& currFrame {mVideoFrameRing[frameIndex]};
+        ++sVideoFramesDecoded;
+
+        if (mGPUColorConversion) {
+            // Copy the Y, U and V planes tightly packed after each other, this also removes
+            // any line padding so there is no need to compensate for that in render().
+            const int width {mVideoFrameResampled->width};
+            const int height {mVideoFrameResampled->height};
+            const int chromaWidth {(width + 1) / 2};
+            const int chromaHeight {(height + 1) / 2};
+            const std::array<int, 3> planeWidths {width, chromaWidth, chromaWidth};
+            const std::array<int, 3> planeHeights {height, chromaHeight, chromaHeight};
+
+            currFrame.frameData.resize(static_cast<size_t>(width * height) +
+                                       static_cast<size_t>(chromaWidth * chromaHeight) * 2);
+            uint8_t* destination {currFrame.frameData.data()};
+
+            for (int plane {0}; plane < 3; ++plane) {
+                const uint8_t* source {mVideoFrameResampled->data[plane]};
+                for (int row {0}; row < planeHeights[plane]; ++row) {
+                    std::memcpy(destination, source, planeWidths[plane]);
+                    destination += planeWidths[plane];
+                    source += mVideoFrameResampled->linesize[plane];
+                }
+            }
+
+            // Videos without colorspace information are assumed to be BT.709 if they are
+            // in HD resolution and BT.601 otherwise, which is the same as what most players do.
+            unsigned int shaderFlags {0};
+            if (mVideoFrameResampled->colorspace == AVCOL_SPC_BT709 ||
+                (mVideoFrameResampled->colorspace == AVCOL_SPC_UNSPECIFIED && height >= 720))
+                shaderFlags |= Renderer::ShaderFlags::YUV_BT709;
+            if (mVideoFrameResampled->color_range == AVCOL_RANGE_JPEG)
+                shaderFlags |= Renderer::ShaderFlags::YUV_FULL_RANGE;
+
+            currFrame.width = width;
+            currFrame.height = height;
+            currFrame.shaderFlags = shaderFlags;
         }
+        else {
+            // This is likely unnecessary as AV_PIX_FMT_RGBA always uses 4 bytes per pixel.
+            // const int bytesPerPixel {
+            //    av_get_padded_bits_per_pixel(av_pix_fmt_desc_get(AV_PIX_FMT_RGBA)) / 8};
+            const int bytesPerPixel {4};
+            const int width {mVideoFrameResampled->linesize[0] / bytesPerPixel};
+
+            // For performance reasons the linesize value may padded to a larger size than the
+            // usable data. This seems to happen mostly (only?) on Windows. If this occurs we
+            // need to compensate for this when calculating the vertices in render().
+            if (width != mVideoFrameResampled->width && width > 0) {
+                const float linePaddingComp {
+                    static_cast<float>(width - mVideoFrameResampled->width) /
+                    static_cast<float>(width)};
+                if (linePaddingComp != 0.0f)
+                    mLinePaddingComp = linePaddingComp;
+            }
+
+            currFrame.width = width;
+            currFrame.height = mVideoFrameResampled->height;
+            currFrame.shaderFlags = 0;
+
+            const int bufferSize {width * mVideoFrameResampled->height * 4};
 
-        currFrame.width = width;
-        currFrame.height = mVideoFrameResampled->height;
+            // The frame buffer has been allocated from the stream size so this will normally
+            // not lead to any memory allocation.
+            currFrame.frameData.assign(&mVideoFrameResampled->data[0][0],
+                                       &mVideoFrameResampled->data[0][bufferSize]);
+        }
 
         mVideoFrameResampled->best_effort_timestamp = mVideoFrameResampled->pkt_dts;
 
@@ -884,13 +1029,7 @@ void VideoFFmpegComponent::getProcessedFrames()
         currFrame.pts = pts;
         currFrame.frameDuration = frameDuration;
 
-        const int bufferSize {width * mVideoFrameResampled->height * 4};
-
-        currFrame.frameRGBA.insert(
-            currFrame.frameRGBA.begin(), std::make_move_iterator(&mVideoFrameResampled->data[0][0]),
-            std::make_move_iterator(&mVideoFrameResampled->data[0][bufferSize]));
-
-        mVideoFrameQueue.emplace(std::move(currFrame));
+        queueVideoFrame(frameIndex);
         av_frame_unref(mVideoFrameResampled);
     }
 
@@ -990,23 +1129,24 @@ void VideoFFmpegComponent::outputFrames()
     // Process all available video frames that have a PTS value below mAccumulatedTime.
     // But if more than one frame is processed here, it means that the computer can't
     // keep up for some reason.
-    while (mIsActuallyPlaying && !mVideoFrameQueue.empty()) {
+    while (mIsActuallyPlaying && mVideoFrameQueueSize > 0) {
+        const VideoFrame& queuedFrame {mVideoFrameRing[mVideoFrameQueue[mVideoFrameQueueHead]]};
+
         // This workaround for broken files with a high PTS value for the first frame is only
         // applied if there are no audio streams available.
         if (!mAudioCodecContext && !mDecodedFrame &&
-            mVideoFrameQueue.size() == static_cast<size_t>(mVideoTargetQueueSize) &&
-            mAccumulatedTime < mVideoFrameQueue.front().pts) {
-            mAccumulatedTime = mVideoFrameQueue.front().pts;
+            mVideoFrameQueueSize == static_cast<size_t>(mVideoTargetQueueSize) &&
+            mAccumulatedTime < queuedFrame.pts) {
+            mAccumulatedTime = queuedFrame.pts;
         }
 
-        if (mVideoFrameQueue.front().pts < mAccumulatedTime) {
+        if (queuedFrame.pts < mAccumulatedTime) {
             // Enable only when needed, as this generates a lot of debug output.
             if (DEBUG_VIDEO) {
-                LOG(LogDebug) << "Processing video frame with PTS: "
-                              << mVideoFrameQueue.front().pts;
+                LOG(LogDebug) << "Processing video frame with PTS: " << queuedFrame.pts;
                 LOG(LogDebug) << "Total video frames processed / video frame queue size: "
                               << mVideoFrameCount << " / "
-                              << std::to_string(mVideoFrameQueue.size());
+                              << std::to_string(mVideoFrameQueueSize);
                 if (mVideoFrameDroppedCount > 0) {
                     LOG(LogDebug) << "Video frames dropped: " << mVideoFrameDroppedCount << " of "
                                   << mVideoFrameReadCount << " (" << std::setprecision(2)
@@ -1027,29 +1167,29 @@ void VideoFFmpegComponent::outputFrames()
             // can't keep up. This approach primarily decreases stuttering for videos with frame
             // rates close to, or at, the rendering frame rate, for example 59.94 and 60 FPS.
             if (mDecodedFrame && !mOutputPicture.hasBeenRendered) {
-                double timeDifference {mAccumulatedTime - mVideoFrameQueue.front().pts -
-                                       mVideoFrameQueue.front().frameDuration * 2.0};
-                if (timeDifference < mVideoFrameQueue.front().frameDuration) {
+                double timeDifference {mAccumulatedTime - queuedFrame.pts -
+                                       queuedFrame.frameDuration * 2.0};
+                if (timeDifference < queuedFrame.frameDuration) {
                     pictureLock.unlock();
                     break;
                 }
+                // The previous frame is skipped without ever having been rendered.
+                ++sVideoFramesDropped;
             }
 
-            mOutputPicture.pictureRGBA.clear();
-            mOutputPicture.pictureRGBA.insert(
-                mOutputPicture.pictureRGBA.begin(),
-                std::make_move_iterator(mVideoFrameQueue.front().frameRGBA.begin()),
-                std::make_move_iterator(mVideoFrameQueue.front().frameRGBA.end()));
-
-            mOutputPicture.width = mVideoFrameQueue.front().width;
-            mOutputPicture.height = mVideoFrameQueue.front().height;
+            // The previous output frame is returned to the ring unless it's being rendered,
+            // in which case the render thread will return it afterwards.
+            const int previousFrameIndex {mOutputPicture.frameIndex};
+            mOutputPicture.frameIndex = dequeueVideoFrame();
             mOutputPicture.hasBeenRendered = false;
 
+            if (previousFrameIndex != -1 && previousFrameIndex != mRenderingFrameIndex)
+                releaseVideoFrame(previousFrameIndex);
+
             mDecodedFrame = true;
 
             pictureLock.unlock();
 
-            mVideoFrameQueue.pop();
             ++mVideoFrameCount;
         }
         else {
@@ -1057,10 +1197,247 @@ void VideoFFmpegComponent::outputFrames()
         }
     }
 
-    if (mReadAllFrames && mVideoFrameQueue.empty())
+    if (mReadAllFrames && mVideoFrameQueueSize == 0)
         mEndOfVideo = true;
 }
 
+void VideoFFmpegComponent::initVideoFrameRing()
+{
+    const size_t ringSize {
+        static_cast<size_t>(std::max(mVideoTargetQueueSize, 1) + VIDEO_FRAME_RING_MARGIN)};
+    // Planar YUV frames use 1.5 bytes per pixel as the chroma planes are subsampled.
+    const size_t pixelCount {static_cast<size_t>(mDecodeSize.x) *
+                             static_cast<size_t>(mDecodeSize.y)};
+    const size_t frameSize {mGPUColorConversion ? pixelCount * 3 / 2 : pixelCount * 4};
+
+    mVideoFrameRing.resize(ringSize);
+    mVideoFrameQueue.assign(ringSize, -1);
+    mVideoFrameQueueHead = 0;
+    mVideoFrameQueueSize = 0;
+    mFreeVideoFrames.clear();
+    mFreeVideoFrames.reserve(ringSize);
+    mRenderingFrameIndex = -1;
+
+    for (size_t i {0}; i < ringSize; ++i) {
+        mVideoFrameRing[i].frameData.reserve(frameSize);
+        mFreeVideoFrames.emplace_back(static_cast<int>(ringSize - i - 1));
+    }
+}
+
+void VideoFFmpegComponent::clearVideoFrameRing()
+{
+    std::deque<VideoFrame>().swap(mVideoFrameRing);
+    std::vector<int>().swap(mVideoFrameQueue);
+    std::vector<int>().swap(mFreeVideoFrames);
+    mVideoFrameQueueHead = 0;
+    mVideoFrameQueueSize = 0;
+    mRenderingFrameIndex = -1;
+}
+
+int VideoFFmpegComponent::acquireVideoFrame()
+{
+    std::unique_lock<std::mutex> pictureLock {mPictureMutex};
+
+    if (!mFreeVideoFrames.empty()) {
+        const int frameIndex {mFreeVideoFrames.back()};
+        mFreeVideoFrames.pop_back();
+        return frameIndex;
+    }
+
+    // The ring is full as the reader is further ahead than the target queue size, which happens
+    // when it keeps reading to fill the audio queue. Add a frame to the ring instead of dropping
+    // queued frames as that would make the video skip and drift out of sync with the audio.
+    // The read-ahead is capped by readFrames() so the ring can't grow indefinitely.
+    const int frameIndex {static_cast<int>(mVideoFrameRing.size())};
+    mVideoFrameRing.emplace_back();
+
+    if (mVideoFrameQueue.size() < mVideoFrameRing.size()) {
+        // Move the queued indexes to the start of a larger circular buffer.
+        std::vector<int> frameQueue(mVideoFrameRing.size() * 2, -1);
+        for (size_t i {0}; i < mVideoFrameQueueSize; ++i)
+            frameQueue[i] = mVideoFrameQueue[(mVideoFrameQueueHead + i) % mVideoFrameQueue.size()];
+        mVideoFrameQueue.swap(frameQueue);
+        mVideoFrameQueueHead = 0;
+    }
+
+    return frameIndex;
+}
+
+void VideoFFmpegComponent::releaseVideoFrame(const int frameIndex)
+{
+    mFreeVideoFrames.emplace_back(frameIndex);
+}
+
+void VideoFFmpegComponent::queueVideoFrame(const int frameIndex)
+{
+    mVideoFrameQueue[(mVideoFrameQueueHead + mVideoFrameQueueSize) % mVideoFrameQueue.size()] =
+        frameIndex;
+    ++mVideoFrameQueueSize;
+}
+
+void VideoFFmpegComponent::uploadVideoFramePlanes(const VideoFrame& frame)
+{
+    const glm::ivec2 chromaSize {(frame.width + 1) / 2, (frame.height + 1) / 2};
+    const std::array<glm::ivec2, 3> planeSizes {glm::ivec2 {frame.width, frame.height},
+                                                chromaSize, chromaSize};
+    const bool createTextures {mPlaneTextures[0] == 0 ||
+                               mPlaneTextureSize != glm::ivec2 {frame.width, frame.height}};
+
+    // The planes need to be tightly packed without any line padding, as done when copying
+    // them from the filter output in getProcessedFrames().
+    assert(frame.frameData.size() == static_cast<size_t>(frame.width * frame.height) +
+                                         static_cast<size_t>(chromaSize.x * chromaSize.y) * 2);
+
+    if (createTextures)
+        destroyPlaneTextures();
+
+    uint8_t* planeData {const_cast<uint8_t*>(frame.frameData.data())};
+
+    for (size_t i {0}; i < mPlaneTextures.size(); ++i) {
+        if (createTextures) {
+            // The chroma planes are always upsampled using linear filtering.
+            mPlaneTextures[i] = mRenderer->createTexture(
+                static_cast<unsigned int>(i), Renderer::TextureType::RED, true,
+                (i == 0 ? mLinearInterpolation : true), false, false, planeSizes[i].x,
+                planeSizes[i].y, planeData);
+        }
+        else {
+            mRenderer->streamTexture(mPlaneTextures[i], static_cast<unsigned int>(i),
+                                     Renderer::TextureType::RED, planeSizes[i].x,
+                                     planeSizes[i].y, planeData);
+        }
+        planeData += static_cast<size_t>(planeSizes[i].x * planeSizes[i].y);
+    }
+
+    mPlaneTextureSize = glm::ivec2 {frame.width, frame.height};
+    mPlaneShaderFlags = frame.shaderFlags;
+}
+
+void VideoFFmpegComponent::destroyPlaneTextures()
+{
+    for (auto& texture : mPlaneTextures) {
+        if (texture != 0) {
+            mRenderer->destroyTexture(texture);
+            texture = 0;
+        }
+    }
+
+    mPlaneTextureSize = glm::ivec2 {0, 0};
+    mPlaneShaderFlags = 0;
+}
+
+int VideoFFmpegComponent::dequeueVideoFrame()
+{
+    assert(mVideoFrameQueueSize > 0);
+    const int frameIndex {mVideoFrameQueue[mVideoFrameQueueHead]};
+    mVideoFrameQueueHead = (mVideoFrameQueueHead + 1) % mVideoFrameQueue.size();
+    --mVideoFrameQueueSize;
+    return frameIndex;
+}
+
+bool VideoFFmpegComponent::showCachedFirstFrame()
+{
+    const FirstFrameKeyType key {std::make_tuple(
+        mStreamPath, static_cast<int>(std::round(mTargetSize.x)),
+        static_cast<int>(std::round(mTargetSize.y)), mGPUColorConversion)};
+
+    auto it = sFirstFrameCache.find(key);
+    if (it == sFirstFrameCache.end())
+        return false;
+
+    // Move the entry to the front of the list.
+    sFirstFrameLRU.splice(sFirstFrameLRU.begin(), sFirstFrameLRU, it->second.lruPosition);
+
+    const CachedFirstFrame& cachedFrame {it->second};
+    if (mGPUColorConversion) {
+        uploadVideoFramePlanes(cachedFrame.frame);
+    }
+    else {
+        mTexture->initFromPixels(cachedFrame.frame.frameData.data(), cachedFrame.frame.width,
+                                 cachedFrame.frame.height);
+    }
+
+    mVideoWidth = cachedFrame.videoWidth;
+    mVideoHeight = cachedFrame.videoHeight;
+    mLinePaddingComp = cachedFrame.linePaddingComp;
+
+    resize();
+    calculateBlackFrame();
+
+    return true;
+}
+
+void VideoFFmpegComponent::cacheFirstFrame(const VideoFrame& frame)
+{
+    const FirstFrameKeyType key {std::make_tuple(
+        mStreamPath, static_cast<int>(std::round(mTargetSize.x)),
+        static_cast<int>(std::round(mTargetSize.y)), mGPUColorConversion)};
+
+    if (sFirstFrameCache.find(key) != sFirstFrameCache.end())
+        return;
+
+    const size_t maxCacheSize {static_cast<size_t>(FIRST_FRAME_CACHE_SIZE) * 1024 * 1024};
+    const size_t frameSize {frame.frameData.size()};
+
+    if (frameSize > maxCacheSize)
+        return;
+
+    while (sFirstFrameCacheSize + frameSize > maxCacheSize && !sFirstFrameLRU.empty()) {
+        auto lastIt = sFirstFrameCache.find(*sFirstFrameLRU.back());
+        sFirstFrameCacheSize -= lastIt->second.frame.frameData.size();
+        sFirstFrameLRU.pop_back();
+        sFirstFrameCache.erase(lastIt);
+    }
+
+    auto it = sFirstFrameCache.emplace(key, CachedFirstFrame {}).first;
+    CachedFirstFrame& cachedFrame {it->second};
+    cachedFrame.frame.frameData.assign(frame.frameData.cbegin(), frame.frameData.cend());
+    cachedFrame.frame.width = frame.width;
+    cachedFrame.frame.height = frame.height;
+    cachedFrame.frame.shaderFlags = frame.shaderFlags;
+    cachedFrame.frame.pts = 0.0;
+    cachedFrame.frame.frameDuration = 0.0;
+    cachedFrame.videoWidth = mVideoWidth;
+    cachedFrame.videoHeight = mVideoHeight;
+    cachedFrame.linePaddingComp = mLinePaddingComp;
+    sFirstFrameLRU.emplace_front(&it->first);
+    cachedFrame.lruPosition = sFirstFrameLRU.begin();
+    sFirstFrameCacheSize += frameSize;
+}
+
+void VideoFFmpegComponent::calculateDecodeSize()
+{
+    const glm::vec2 videoSize {static_cast<float>(mVideoCodecContext->width),
+                               static_cast<float>(mVideoCodecContext->height)};
+    mDecodeSize = glm::ivec2 {mVideoCodecContext->width, mVideoCodecContext->height};
+
+    if (mTargetSize.x <= 0.0f || mTargetSize.y <= 0.0f || videoSize.x <= 0.0f ||
+        videoSize.y <= 0.0f)
+        return;
+
+    // If the video is scaled to fit inside the target size then it's enough to decode at that
+    // size, but for cropped and stretched videos both axes must cover the target size.
+    const glm::vec2 scale {mTargetSize / videoSize};
+    const float scaleFactor {mTargetIsMax ? std::min(scale.x, scale.y) :
+                                            std::max(scale.x, scale.y)};
+
+    // Never upscale, that is better left to the GPU.
+    if (scaleFactor >= 1.0f)
+        return;
+
+    // Use even dimensions as the chroma planes are subsampled by a factor of two.
+    mDecodeSize.x = std::max(2, static_cast<int>(std::ceil(videoSize.x * scaleFactor / 2.0f)) * 2);
+    mDecodeSize.y = std::max(2, static_cast<int>(std::ceil(videoSize.y * scaleFactor / 2.0f)) * 2);
+
+    // The rounding may have brought the size back to the source size.
+    if (mDecodeSize.x >= mVideoCodecContext->width || mDecodeSize.y >= mVideoCodecContext->height)
+        mDecodeSize = glm::ivec2 {mVideoCodecContext->width, mVideoCodecContext->height};
+
+    LOG(LogDebug) << "VideoFFmpegComponent::calculateDecodeSize(): Scaling video frames from "
+                  << mVideoCodecContext->width << "x" << mVideoCodecContext->height << " to "
+                  << mDecodeSize.x << "x" << mDecodeSize.y;
+}
+
 void VideoFFmpegComponent::calculateBlackFrame()
 {
     // Calculate the position and size for the black frame image that will be rendered behind
@@ -1226,7 +1603,7 @@ bool VideoFFmpegComponent::decoderInitHW()
 
     // If the hardware decoding of the file was previously unsuccessful during the program
     // session, then don't attempt it again.
-    if (std::find(sSWDecodedVideos.begin(), sSWDecodedVideos.end(), mVideoPath) !=
+    if (std::find(sSWDecodedVideos.begin(), sSWDecodedVideos.end(), mStreamPath) !=
         sSWDecodedVideos.end()) {
         return true;
     }
@@ -1272,7 +1649,7 @@ bool VideoFFmpegComponent::decoderInitHW()
     };
 
     // Check if the video can actually be hardware decoded (unless this has already been done).
-    if (std::find(sHWDecodedVideos.begin(), sHWDecodedVideos.end(), mVideoPath) ==
+    if (std::find(sHWDecodedVideos.begin(), sHWDecodedVideos.end(), mStreamPath) ==
         sHWDecodedVideos.end()) {
 
         // clang-format on
@@ -1281,7 +1658,7 @@ bool VideoFFmpegComponent::decoderInitHW()
         if (avcodec_parameters_to_context(checkCodecContext, mVideoStream->codecpar)) {
             LOG(LogError) << "VideoFFmpegComponent::decoderInitHW(): "
                              "Couldn't fill the video codec context parameters for file \""
-                          << mVideoPath << "\"";
+                          << mStreamPath << "\"";
             avcodec_free_context(&checkCodecContext);
             return true;
         }
@@ -1294,7 +1671,7 @@ bool VideoFFmpegComponent::decoderInitHW()
             if (avcodec_open2(checkCodecContext, mHardwareCodec, nullptr)) {
                 LOG(LogError) << "VideoFFmpegComponent::decoderInitHW(): "
                                  "Couldn't initialize the video codec context for file \""
-                              << mVideoPath << "\"";
+                              << mStreamPath << "\"";
             }
 
             AVPacket* checkPacket {av_packet_alloc()};
@@ -1314,7 +1691,7 @@ bool VideoFFmpegComponent::decoderInitHW()
                 if (avcodec_send_packet(checkCodecContext, checkPacket) < 0) {
                     // Save the file path to the list of videos that require software decoding
                     // so we don't have to check it again during the program session.
-                    sSWDecodedVideos.emplace_back(mVideoPath);
+                    sSWDecodedVideos.emplace_back(mStreamPath);
                     onlySWDecode = true;
                 }
                 else {
@@ -1358,7 +1735,7 @@ bool VideoFFmpegComponent::decoderInitHW()
                     if (onlySWDecode == false) {
                         // Save the file path to the list of videos that work with hardware
                         // decoding so we don't have to check it again during the program session.
-                        sHWDecodedVideos.emplace_back(mVideoPath);
+                        sHWDecodedVideos.emplace_back(mStreamPath);
                     }
                 }
 
@@ -1381,7 +1758,7 @@ bool VideoFFmpegComponent::decoderInitHW()
     if (!mVideoCodecContext) {
         LOG(LogError) << "VideoFFmpegComponent::decoderInitHW(): "
                          "Couldn't allocate video codec context for file \""
-                      << mVideoPath << "\"";
+                      << mStreamPath << "\"";
         avcodec_free_context(&mVideoCodecContext);
         return true;
     }
@@ -1389,7 +1766,7 @@ bool VideoFFmpegComponent::decoderInitHW()
     if (avcodec_parameters_to_context(mVideoCodecContext, mVideoStream->codecpar)) {
         LOG(LogError) << "VideoFFmpegComponent::decoderInitHW(): "
                          "Couldn't fill the video codec context parameters for file \""
-                      << mVideoPath << "\"";
+                      << mStreamPath << "\"";
         avcodec_free_context(&mVideoCodecContext);
         return true;
     }
@@ -1400,7 +1777,7 @@ bool VideoFFmpegComponent::decoderInitHW()
     if (avcodec_open2(mVideoCodecContext, mHardwareCodec, nullptr)) {
         LOG(LogError) << "VideoFFmpegComponent::decoderInitHW(): "
                          "Couldn't initialize the video codec context for file \""
-                      << mVideoPath << "\"";
+                      << mStreamPath << "\"";
         avcodec_free_context(&mVideoCodecContext);
         return true;
     }
@@ -1415,24 +1792,36 @@ void VideoFFmpegComponent::startVideoStream()
 
     mIsPlaying = true;
 
-    if (!mFormatContext) {
+    if (mStreamState == StreamState::SETTING_UP && mStreamSetupDone) {
+        mStreamSetupThread->join();
+        mStreamSetupThread.reset();
+        finishVideoStreamSetup();
+        return;
+    }
+
+    if (mStreamState == StreamState::STOPPED) {
         mHardwareCodec = nullptr;
         mHwContext = nullptr;
-        mFrameProcessingThread = nullptr;
         mVideoWidth = 0;
         mVideoHeight = 0;
         mLinePaddingComp = 0.0f;
         mAccumulatedTime = 0.0;
         mStartTimeAccumulation = false;
         mSWDecoder = true;
+        // The scanline shader only supports RGB textures, so the pixel format conversion needs
+        // to be done on the CPU if that shader is used.
+        mGPUColorConversion = Settings::getInstance()->getBool("VideoGPUColorConversion") &&
+                              (!mRenderScanlines || mScreensaverMode || mMediaViewerMode);
         mDecodedFrame = false;
         mReadAllFrames = false;
         mEndOfVideo = false;
+        mResyncStreams = false;
         mVideoFrameCount = 0;
         mAudioFrameCount = 0;
         mVideoFrameReadCount = 0;
         mVideoFrameDroppedCount = 0;
         mOutputPicture = {};
+        clearVideoFrameRing();
 
         // Get an empty texture for rendering the video.
         mTexture = TextureResource::get("");
@@ -1441,199 +1830,258 @@ void VideoFFmpegComponent::startVideoStream()
         // This is used for the audio and video synchronization.
         mTimeReference = std::chrono::high_resolution_clock::now();
 
-        // Clear the video and audio frame queues.
-        std::queue<VideoFrame>().swap(mVideoFrameQueue);
+        // Clear the audio frame queue.
         std::queue<AudioFrame>().swap(mAudioFrameQueue);
 
-        std::string filePath {"file:" + mVideoPath};
+        mStreamPath = mVideoPath;
+
+        // If the first frame of the video has been cached then it's rendered until the stream
+        // setup has completed, which avoids showing a black frame while browsing.
+        mCachedFrameShown = showCachedFirstFrame();
+        mFirstFrameCached = mCachedFrameShown;
+        if (mCachedFrameShown)
+            mFadeIn = 0.0f;
+
+        mStreamSetupDone = false;
+        mStreamSetupSucceeded = false;
+        mStreamState = StreamState::SETTING_UP;
+
+        mStreamSetupThread = std::make_unique<std::thread>([this] {
+            mStreamSetupSucceeded = openVideoStream();
+            mStreamSetupDone = true;
+        });
+    }
+}
+
+bool VideoFFmpegComponent::openVideoStream()
+{
+    std::string filePath {"file:" + mStreamPath};
+
+    // This will disable the FFmpeg logging, so comment this out if debug info is needed.
+    av_log_set_callback(nullptr);
 
-        // This will disable the FFmpeg logging, so comment this out if debug info is needed.
-        av_log_set_callback(nullptr);
+    // File operations and basic setup.
 
-        // File operations and basic setup.
+    // The interrupt callback makes it possible to abort slow file operations if the video
+    // player is stopped before the setup has completed.
+    mFormatContext = avformat_alloc_context();
+    mFormatContext->interrupt_callback.callback = &VideoFFmpegComponent::interruptCallback;
+    mFormatContext->interrupt_callback.opaque = this;
 
-        if (avformat_open_input(&mFormatContext, filePath.c_str(), nullptr, nullptr)) {
-            LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
+    // Don't log any errors if the setup was aborted.
+    if (avformat_open_input(&mFormatContext, filePath.c_str(), nullptr, nullptr)) {
+        if (mIsPlaying) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
                              "Couldn't open video file \""
-                          << mVideoPath << "\"";
-            return;
+                          << mStreamPath << "\"";
         }
+        return false;
+    }
 
-        if (avformat_find_stream_info(mFormatContext, nullptr)) {
-            LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
+    if (avformat_find_stream_info(mFormatContext, nullptr)) {
+        if (mIsPlaying) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
                              "Couldn't read stream information from video file \""
-                          << mVideoPath << "\"";
-            return;
+                          << mStreamPath << "\"";
         }
+        return false;
+    }
 
-        mVideoStreamIndex = -1;
-        mAudioStreamIndex = -1;
+    mVideoStreamIndex = -1;
+    mAudioStreamIndex = -1;
 
-        // Video stream setup.
+    // Video stream setup.
 
 #if defined(VIDEO_HW_DECODING)
-        bool hwDecoding {Settings::getInstance()->getBool("VideoHardwareDecoding")};
+    bool hwDecoding {Settings::getInstance()->getBool("VideoHardwareDecoding")};
 #else
-        bool hwDecoding {false};
+    bool hwDecoding {false};
 #endif
 
 #if LIBAVUTIL_VERSION_MAJOR > 56
-        mVideoStreamIndex = av_find_best_stream(mFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1,
-                                                const_cast<const AVCodec**>(&mHardwareCodec), 0);
+    mVideoStreamIndex = av_find_best_stream(mFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                            const_cast<const AVCodec**>(&mHardwareCodec), 0);
 #else
-        mVideoStreamIndex =
-            av_find_best_stream(mFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1, &mHardwareCodec, 0);
+    mVideoStreamIndex =
+        av_find_best_stream(mFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1, &mHardwareCodec, 0);
 #endif
 
-        if (mVideoStreamIndex < 0) {
-            LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                             "Couldn't retrieve video stream for file \""
-                          << mVideoPath << "\"";
-            avformat_close_input(&mFormatContext);
-            avformat_free_context(mFormatContext);
-            return;
-        }
+    if (mVideoStreamIndex < 0) {
+        LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                         "Couldn't retrieve video stream for file \""
+                      << mStreamPath << "\"";
+        avformat_close_input(&mFormatContext);
+        avformat_free_context(mFormatContext);
+        return false;
+    }
 
-        mVideoStream = mFormatContext->streams[mVideoStreamIndex];
-        mVideoWidth = mFormatContext->streams[mVideoStreamIndex]->codecpar->width;
-        mVideoHeight = mFormatContext->streams[mVideoStreamIndex]->codecpar->height;
+    mVideoStream = mFormatContext->streams[mVideoStreamIndex];
 
-        LOG(LogDebug) << "VideoFFmpegComponent::startVideoStream(): "
+    LOG(LogDebug) << "VideoFFmpegComponent::openVideoStream(): "
 #if defined(_WIN64)
-                      << "Playing video \"" << Utils::String::replace(mVideoPath, "/", "\\")
-                      << "\" (codec: "
+                  << "Playing video \"" << Utils::String::replace(mStreamPath, "/", "\\")
+                  << "\" (codec: "
 #else
-                      << "Playing video \"" << mVideoPath << "\" (codec: "
+                  << "Playing video \"" << mStreamPath << "\" (codec: "
 #endif
-                      << avcodec_get_name(
-                             mFormatContext->streams[mVideoStreamIndex]->codecpar->codec_id)
-                      << ", decoder: " << (hwDecoding ? "hardware" : "software") << ")";
-
-        if (hwDecoding)
-            mSWDecoder = decoderInitHW();
-        else
-            mSWDecoder = true;
-
-        if (mSWDecoder) {
-            // The hardware decoder initialization failed, which can happen for a number of reasons.
-            if (hwDecoding) {
-                LOG(LogDebug)
-                    << "VideoFFmpegComponent::startVideoStream(): Hardware decoding failed, "
-                       "falling back to software decoder";
-            }
+                  << avcodec_get_name(
+                         mFormatContext->streams[mVideoStreamIndex]->codecpar->codec_id)
+                  << ", decoder: " << (hwDecoding ? "hardware" : "software") << ")";
 
-            mVideoCodec =
-                const_cast<AVCodec*>(avcodec_find_decoder(mVideoStream->codecpar->codec_id));
+    if (hwDecoding) {
+        std::unique_lock<std::mutex> hwDecoderLock {sHWDecoderMutex};
+        mSWDecoder = decoderInitHW();
+    }
+    else {
+        mSWDecoder = true;
+    }
 
-            if (!mVideoCodec) {
-                LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                 "Couldn't find a suitable video codec for file \""
-                              << mVideoPath << "\"";
-                return;
-            }
+    if (mSWDecoder) {
+        // The hardware decoder initialization failed, which can happen for a number of reasons.
+        if (hwDecoding) {
+            LOG(LogDebug)
+                << "VideoFFmpegComponent::openVideoStream(): Hardware decoding failed, "
+                   "falling back to software decoder";
+        }
 
-            mVideoCodecContext = avcodec_alloc_context3(mVideoCodec);
+        mVideoCodec =
+            const_cast<AVCodec*>(avcodec_find_decoder(mVideoStream->codecpar->codec_id));
 
-            if (!mVideoCodecContext) {
-                LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                 "Couldn't allocate video codec context for file \""
-                              << mVideoPath << "\"";
-                return;
-            }
+        if (!mVideoCodec) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                             "Couldn't find a suitable video codec for file \""
+                          << mStreamPath << "\"";
+            return false;
+        }
+
+        mVideoCodecContext = avcodec_alloc_context3(mVideoCodec);
+
+        if (!mVideoCodecContext) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                             "Couldn't allocate video codec context for file \""
+                          << mStreamPath << "\"";
+            return false;
+        }
 
 #if LIBAVUTIL_VERSION_MAJOR < 58
-            if (mVideoCodec->capabilities & AV_CODEC_CAP_TRUNCATED)
-                mVideoCodecContext->flags |= AV_CODEC_FLAG_TRUNCATED;
+        if (mVideoCodec->capabilities & AV_CODEC_CAP_TRUNCATED)
+            mVideoCodecContext->flags |= AV_CODEC_FLAG_TRUNCATED;
 #endif
 
-            if (avcodec_parameters_to_context(mVideoCodecContext, mVideoStream->codecpar)) {
-                LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                 "Couldn't fill the video codec context parameters for file \""
-                              << mVideoPath << "\"";
-                return;
-            }
+        if (avcodec_parameters_to_context(mVideoCodecContext, mVideoStream->codecpar)) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                             "Couldn't fill the video codec context parameters for file \""
+                          << mStreamPath << "\"";
+            return false;
+        }
 
-            if (avcodec_open2(mVideoCodecContext, mVideoCodec, nullptr)) {
-                LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                 "Couldn't initialize the video codec context for file \""
-                              << mVideoPath << "\"";
-                return;
-            }
+        if (avcodec_open2(mVideoCodecContext, mVideoCodec, nullptr)) {
+            LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                             "Couldn't initialize the video codec context for file \""
+                          << mStreamPath << "\"";
+            return false;
         }
+    }
 
-        // Audio stream setup, optional as some videos do not have any audio tracks.
-        // Audio can also be disabled per video via the theme configuration.
+    // Audio stream setup, optional as some videos do not have any audio tracks.
+    // Audio can also be disabled per video via the theme configuration.
 
-        if (mPlayAudio) {
-            mAudioStreamIndex =
-                av_find_best_stream(mFormatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (mPlayAudio) {
+        mAudioStreamIndex =
+            av_find_best_stream(mFormatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
 
-            if (mAudioStreamIndex < 0) {
-                LOG(LogDebug) << "VideoFFmpegComponent::startVideoStream(): "
-                                 "File does not seem to contain any audio streams";
-            }
+        if (mAudioStreamIndex < 0) {
+            LOG(LogDebug) << "VideoFFmpegComponent::openVideoStream(): "
+                             "File does not seem to contain any audio streams";
+        }
 
-            if (mAudioStreamIndex >= 0) {
-                mAudioStream = mFormatContext->streams[mAudioStreamIndex];
-                mAudioCodec =
-                    const_cast<AVCodec*>(avcodec_find_decoder(mAudioStream->codecpar->codec_id));
+        if (mAudioStreamIndex >= 0) {
+            mAudioStream = mFormatContext->streams[mAudioStreamIndex];
+            mAudioCodec =
+                const_cast<AVCodec*>(avcodec_find_decoder(mAudioStream->codecpar->codec_id));
 
-                if (!mAudioCodec) {
-                    LOG(LogError) << "Couldn't find a suitable audio codec for file \""
-                                  << mVideoPath << "\"";
-                    return;
-                }
+            if (!mAudioCodec) {
+                LOG(LogError) << "Couldn't find a suitable audio codec for file \""
+                              << mStreamPath << "\"";
+                return false;
+            }
 
-                mAudioCodecContext = avcodec_alloc_context3(mAudioCodec);
+            mAudioCodecContext = avcodec_alloc_context3(mAudioCodec);
 
 #if LIBAVUTIL_VERSION_MAJOR < 58
-                if (mAudioCodec->capabilities & AV_CODEC_CAP_TRUNCATED)
-                    mAudioCodecContext->flags |= AV_CODEC_FLAG_TRUNCATED;
+            if (mAudioCodec->capabilities & AV_CODEC_CAP_TRUNCATED)
+                mAudioCodecContext->flags |= AV_CODEC_FLAG_TRUNCATED;
 #endif
 
-                // Some formats want separate stream headers.
-                if (mAudioCodecContext->flags & AVFMT_GLOBALHEADER)
-                    mAudioCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            // Some formats want separate stream headers.
+            if (mAudioCodecContext->flags & AVFMT_GLOBALHEADER)
+                mAudioCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-                if (avcodec_parameters_to_context(mAudioCodecContext, mAudioStream->codecpar)) {
-                    LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                     "Couldn't fill the audio codec context parameters for file \""
-                                  << mVideoPath << "\"";
-                    return;
-                }
+            if (avcodec_parameters_to_context(mAudioCodecContext, mAudioStream->codecpar)) {
+                LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                                 "Couldn't fill the audio codec context parameters for file \""
+                              << mStreamPath << "\"";
+                return false;
+            }
 
-                if (avcodec_open2(mAudioCodecContext, mAudioCodec, nullptr)) {
-                    LOG(LogError) << "VideoFFmpegComponent::startVideoStream(): "
-                                     "Couldn't initialize the audio codec context for file \""
-                                  << mVideoPath << "\"";
-                    return;
-                }
+            if (avcodec_open2(mAudioCodecContext, mAudioCodec, nullptr)) {
+                LOG(LogError) << "VideoFFmpegComponent::openVideoStream(): "
+                                 "Couldn't initialize the audio codec context for file \""
+                              << mStreamPath << "\"";
+                return false;
             }
         }
+    }
 
-        mVideoTimeBase = 1.0l / av_q2d(mVideoStream->avg_frame_rate);
+    mVideoTimeBase = 1.0l / av_q2d(mVideoStream->avg_frame_rate);
 
-        // Set some reasonable target queue sizes (buffers).
-        mVideoTargetQueueSize = static_cast<int>(av_q2d(mVideoStream->avg_frame_rate) / 2.0l);
-        if (mAudioStreamIndex >= 0)
-            mAudioTargetQueueSize = mAudioStream->codecpar->CHANNELS * 15;
-        else
-            mAudioTargetQueueSize = 30;
+    // Set some reasonable target queue sizes (buffers).
+    mVideoTargetQueueSize = static_cast<int>(av_q2d(mVideoStream->avg_frame_rate) / 2.0l);
+    if (mAudioStreamIndex >= 0)
+        mAudioTargetQueueSize = mAudioStream->codecpar->CHANNELS * 15;
+    else
+        mAudioTargetQueueSize = 30;
 
-        mPacket = av_packet_alloc();
-        mVideoFrame = av_frame_alloc();
-        mVideoFrameResampled = av_frame_alloc();
-        mAudioFrame = av_frame_alloc();
-        mAudioFrameResampled = av_frame_alloc();
+    mPacket = av_packet_alloc();
+    mVideoFrame = av_frame_alloc();
+    mVideoFrameResampled = av_frame_alloc();
+    mAudioFrame = av_frame_alloc();
+    mAudioFrameResampled = av_frame_alloc();
 
-        // Resize the video surface, which is needed both for the gamelist view and for
-        // the video screeensaver.
-        resize();
+    return true;
+}
 
-        calculateBlackFrame();
+void VideoFFmpegComponent::finishVideoStreamSetup()
+{
+    if (!mStreamSetupSucceeded) {
+        mStreamState = StreamState::FAILED;
+        mCachedFrameShown = false;
+        return;
+    }
+
+    mVideoWidth = mVideoStream->codecpar->width;
+    mVideoHeight = mVideoStream->codecpar->height;
+
+    calculateDecodeSize();
+    initVideoFrameRing();
+
+    // Resize the video surface, which is needed both for the gamelist view and for
+    // the video screeensaver.
+    resize();
 
+    calculateBlackFrame();
+
+    if (!mCachedFrameShown)
         mFadeIn = 0.0f;
-    }
+
+    // The setup may have taken a while so restart the audio and video synchronization.
+    mTimeReference = std::chrono::high_resolution_clock::now();
+    mStreamState = StreamState::READY;
+}
+
+int VideoFFmpegComponent::interruptCallback(void* opaque)
+{
+    return !static_cast<VideoFFmpegComponent*>(opaque)->mIsPlaying;
 }
 
 void VideoFFmpegComponent::stopVideoPlayer(bool muteAudio)
@@ -1646,19 +2094,36 @@ void VideoFFmpegComponent::stopVideoPlayer(bool muteAudio)
     mPaused = false;
     mReadAllFrames = false;
     mEndOfVideo = false;
+    mResyncStreams = false;
     mTexture.reset();
+    destroyPlaneTextures();
+    mCachedFrameShown = false;
+    mPrefetched = false;
+
+    // The interrupt callback will abort any slow file operations as mIsPlaying is now false.
+    if (mStreamSetupThread) {
+        mStreamSetupThread->join();
+        mStreamSetupThread.reset();
+    }
 
-    if (mFrameProcessingThread) {
+    if (mVideoWorkerID != 0) {
         if (mWindow->getVideoPlayerCount() == 0)
             AudioManager::getInstance().muteStream();
-        // Wait for the thread execution to complete.
-        mFrameProcessingThread->join();
-        mFrameProcessingThread.reset();
+        // Wait for any ongoing frame processing to complete.
+        VideoWorkerPool::getInstance().removePlayer(mVideoWorkerID);
+        mVideoWorkerID = 0;
+        finishFrameProcessing();
         mOutputAudio.clear();
     }
 
+    if (mPlayerCounted) {
+        mWindow->decreaseVideoPlayerCount();
+        mPlayerCounted = false;
+    }
+
     // Clear the video and audio frame queues.
-    std::queue<VideoFrame>().swap(mVideoFrameQueue);
+    clearVideoFrameRing();
+    mOutputPicture = {};
     std::queue<AudioFrame>().swap(mAudioFrameQueue);
 
     // Clear the audio buffer.
@@ -1681,6 +2146,8 @@ void VideoFFmpegComponent::stopVideoPlayer(bool muteAudio)
         mAudioCodecContext = nullptr;
         mFormatContext = nullptr;
     }
+
+    mStreamState = StreamState::STOPPED;
 }
 
 void VideoFFmpegComponent::pauseVideoPlayer()
@@ -1689,6 +2156,32 @@ void VideoFFmpegComponent::pauseVideoPlayer()
     mPaused = true;
 }
 
+void VideoFFmpegComponent::prefetchVideoPlayer()
+{
+    // This makes startVideoPlayer() promote the player instead of restarting it.
+    mPrefetched = true;
+
+    // This starts the stream setup, and completes it once the setup thread has finished.
+    if (mStreamState != StreamState::READY) {
+        startVideoStream();
+        return;
+    }
+
+    if (mPaused)
+        return;
+
+    // No time is accumulated while prefetching, so only the first frames are decoded and
+    // nothing is output until the first regular update.
+    std::unique_lock<std::mutex> audioLock {mAudioMutex};
+    mTimeReference = std::chrono::high_resolution_clock::now();
+    audioLock.unlock();
+
+    if (mVideoWorkerID == 0) {
+        mVideoWorkerID = VideoWorkerPool::getInstance().addPlayer(
+            std::bind(&VideoFFmpegComponent::frameProcessing, this), 0.0f);
+    }
+}
+
 void VideoFFmpegComponent::handleLooping()
 {
     if (mIsPlaying && mEndOfVideo) {
@@ -24,11 +24,16 @@ extern "C" {
 #include <libavutil/imgutils.h>
 }
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <deque>
+#include <list>
+#include <map>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <tuple>
 
 class VideoFFmpegComponent : public VideoComponent
 {
@@ -52,6 +57,7 @@ public:
     // Basic video controls.
     void stopVideoPlayer(bool muteAudio = true) override;
     void pauseVideoPlayer() override;
+    void prefetchVideoPlayer() override;
     // Handle looping of the video. Must be called periodically.
     void handleLooping() override;
     // Used to immediately mute audio even if there are samples to play in the buffer.
@@ -59,8 +65,45 @@ public:
     // Needed to be able to display the default image even if no image types have been defined.
     const std::string getDefaultImage() const override { return mDefaultImagePath; }
 
+    struct VideoFrameStatistics {
+        unsigned long decoded;
+        unsigned long dropped;
+        unsigned long copied;
+    };
+
+    // Frame counters for all video players combined.
+    static const VideoFrameStatistics getVideoFrameStatistics()
+    {
+        return VideoFrameStatistics {sVideoFramesDecoded, sVideoFramesDropped, sVideoFramesCopied};
+    }
+
 private:
+    struct VideoFrame {
+        // Either BGRA pixels or tightly packed Y, U and V planes in YUV420P format.
+        std::vector<uint8_t> frameData;
+        int width;
+        int height;
+        // BT.709 and full range flags for YUV frames.
+        unsigned int shaderFlags;
+        double pts;
+        double frameDuration;
+    };
+
+    enum class StreamState {
+        STOPPED,
+        SETTING_UP, // Running in the background.
+        READY,
+        FAILED
+    };
+
     void startVideoStream() override;
+    // Open the file, probe the streams and initialize the decoders. This is run in a separate
+    // thread so that browsing is not blocked and so the cached first frame can be shown.
+    bool openVideoStream();
+    // Called from the main thread after openVideoStream() has completed.
+    void finishVideoStreamSetup();
+    // Used as the FFmpeg I/O interrupt callback to abort the stream setup when stopping.
+    static int interruptCallback(void* opaque);
 
     // Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
     // Used internally whenever the resizing parameters or texture change.
@@ -69,8 +112,10 @@ private:
     void render(const glm::mat4& parentTrans) override;
     void updatePlayer() override;
 
-    // This will run the frame processing in a separate thread.
+    // Called repeatedly by the video worker pool, one iteration of reading, decoding and
+    // filtering frames. The filter graphs are set up on the first call.
     void frameProcessing();
+    void finishFrameProcessing();
     // Setup libavfilter.
     bool setupVideoFilters();
     bool setupAudioFilters();
@@ -85,6 +130,28 @@ private:
     // Calculate the black frame that is rendered behind all videos and which may also be
     // adding pillarboxes/letterboxes.
     void calculateBlackFrame();
+    // Calculate the size to scale the decoded frames to, based on the on-screen size.
+    void calculateDecodeSize();
+
+    // Allocate the video frame ring, sized from the video stream.
+    void initVideoFrameRing();
+    void clearVideoFrameRing();
+    // Returns a ring index that can be filled with a new frame, the ring is grown if it's full.
+    int acquireVideoFrame();
+    // Returns a frame to the ring after it's no longer used for output or rendering.
+    // Must be called with mPictureMutex locked.
+    void releaseVideoFrame(const int frameIndex);
+    void queueVideoFrame(const int frameIndex);
+    int dequeueVideoFrame();
+
+    // Upload the Y, U and V planes of a frame, used when the pixel format conversion is done
+    // by the shader instead of by libavfilter.
+    void uploadVideoFramePlanes(const VideoFrame& frame);
+    void destroyPlaneTextures();
+
+    // Show the first frame of the video from the cache, if it's available.
+    bool showCachedFirstFrame();
+    void cacheFirstFrame(const VideoFrame& frame);
 
     // Detect and initialize the hardware decoder.
     static void detectHWDecoder();
@@ -96,11 +163,51 @@ private:
     // clang-format on
     static inline std::vector<std::string> sSWDecodedVideos;
     static inline std::vector<std::string> sHWDecodedVideos;
+    // The hardware decoder setup may run from multiple stream setup threads at once.
+    static inline std::mutex sHWDecoderMutex;
+
+    // Video path, target width, target height, YUV planes.
+    using FirstFrameKeyType = std::tuple<std::string, int, int, bool>;
+    struct CachedFirstFrame {
+        VideoFrame frame;
+        unsigned int videoWidth;
+        unsigned int videoHeight;
+        float linePaddingComp;
+        std::list<const FirstFrameKeyType*>::iterator lruPosition;
+    };
+    // Least recently used cache of the first frame of each video along with the probed video
+    // size, used to render the video immediately while the stream is set up in the background.
+    // The most recently used entries are at the front of the list. Only accessed by the
+    // main thread.
+    static inline std::map<FirstFrameKeyType, CachedFirstFrame> sFirstFrameCache;
+    static inline std::list<const FirstFrameKeyType*> sFirstFrameLRU;
+    static inline size_t sFirstFrameCacheSize {0};
+
+    static inline std::atomic<unsigned long> sVideoFramesDecoded {0};
+    static inline std::atomic<unsigned long> sVideoFramesDropped {0};
+    static inline std::atomic<unsigned long> sVideoFramesCopied {0};
 
     std::shared_ptr<TextureResource> mTexture;
+    std::array<unsigned int, 3> mPlaneTextures;
+    glm::ivec2 mPlaneTextureSize;
+    unsigned int mPlaneShaderFlags;
     glm::vec2 mBlackFrameOffset;
-
-    std::unique_ptr<std::thread> mFrameProcessingThread;
+    glm::ivec2 mDecodeSize;
+
+    unsigned int mVideoWorkerID;
+    bool mFrameProcessingStarted;
+    bool mVideoFilter;
+    bool mAudioFilter;
+    std::unique_ptr<std::thread> mStreamSetupThread;
+    std::atomic<bool> mStreamSetupDone;
+    std::atomic<bool> mStreamSetupSucceeded;
+    StreamState mStreamState;
+    // Copy of mVideoPath used by the stream setup thread.
+    std::string mStreamPath;
+    bool mCachedFrameShown;
+    bool mFirstFrameCached;
+    // Whether the player is included in the video player count of the window.
+    bool mPlayerCounted;
     std::mutex mPictureMutex;
     std::mutex mAudioMutex;
 
@@ -122,27 +229,31 @@ private:
     AVFrame* mAudioFrame;
     AVFrame* mAudioFrameResampled;
 
-    struct VideoFrame {
-        std::vector<uint8_t> frameRGBA;
-        int width;
-        int height;
-        double pts;
-        double frameDuration;
-    };
-
     struct AudioFrame {
         std::vector<uint8_t> resampledData;
         double pts;
     };
 
     struct OutputPicture {
-        std::vector<uint8_t> pictureRGBA;
-        bool hasBeenRendered;
-        int width;
-        int height;
+        // Index into mVideoFrameRing, or -1 if no frame has been output yet.
+        int frameIndex {-1};
+        bool hasBeenRendered {false};
     };
 
-    std::queue<VideoFrame> mVideoFrameQueue;
+    // Pre-allocated frame buffers that are filled by the frame processing thread and consumed
+    // by the render thread by index, so no memory is allocated or moved around per frame.
+    // A deque is used as growing it doesn't invalidate references to the existing frames.
+    std::deque<VideoFrame> mVideoFrameRing;
+    // Frames waiting to be output, stored as a circular buffer of ring indexes. Only accessed
+    // by the frame processing thread.
+    std::vector<int> mVideoFrameQueue;
+    size_t mVideoFrameQueueHead;
+    size_t mVideoFrameQueueSize;
+    // Ring indexes that are not in use, protected by mPictureMutex.
+    std::vector<int> mFreeVideoFrames;
+    // The frame currently being copied to the texture by the render thread.
+    int mRenderingFrameIndex;
+
     std::queue<AudioFrame> mAudioFrameQueue;
     OutputPicture mOutputPicture;
     std::vector<uint8_t> mOutputAudio;
@@ -177,7 +288,10 @@ private:
     std::atomic<bool> mDecodedFrame;
     std::atomic<bool> mReadAllFrames;
     std::atomic<bool> mEndOfVideo;
+    // Set by updatePlayer() to make the frame processing thread resynchronize the queues.
+    std::atomic<bool> mResyncStreams;
     bool mSWDecoder;
+    bool mGPUColorConversion;
 };
 
 #endif // ES_CORE_COMPONENTS_VIDEO_FFMPEG_COMPONENT_H
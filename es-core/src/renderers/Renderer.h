@@ -56,7 +56,11 @@ public:
         ROTATED               = 0x00000010, // Screen rotated 90 or 270 degrees.
         ROUNDED_CORNERS       = 0x00000020,
         ROUNDED_CORNERS_NO_AA = 0x00000040,
-        CONVERT_PIXEL_FORMAT  = 0x00000080
+        CONVERT_PIXEL_FORMAT  = 0x00000080,
+        SDF_FONT_TEXTURE      = 0x00000100,
+        YUV_VIDEO             = 0x00000200,
+        YUV_BT709             = 0x00000400,
+        YUV_FULL_RANGE        = 0x00000800
     };
     // clang-format on
 
@@ -154,6 +158,13 @@ public:
         }
     };
 
+    // Counters for the current frame, used by the frame statistics.
+    struct RenderStatistics {
+        unsigned int drawCalls;
+        unsigned int textureUploads;
+        size_t textureUploadBytes;
+    };
+
     static Renderer* getInstance();
 
     void setIcon();
@@ -217,6 +228,14 @@ public:
                                const unsigned int width,
                                const unsigned int height,
                                void* data) = 0;
+    // Replaces the entire texture contents using a pixel buffer object so that the transfer
+    // to VRAM can take place asynchronously. Used for textures that are updated every frame.
+    virtual void streamTexture(const unsigned int texture,
+                               const unsigned int texUnit,
+                               const TextureType type,
+                               const unsigned int width,
+                               const unsigned int height,
+                               void* data) = 0;
     virtual void bindTexture(const unsigned int texture, const unsigned int texUnit) = 0;
     virtual void drawTriangleStrips(
         const Vertex* vertices,
@@ -233,7 +252,11 @@ public:
     virtual void setSwapInterval() = 0;
     virtual void swapBuffers() = 0;
 
+    const RenderStatistics& getRenderStatistics() { return mRenderStatistics; }
+    void resetRenderStatistics() { mRenderStatistics = {}; }
+
 protected:
+    RenderStatistics mRenderStatistics {};
     Rect mViewport;
     int mWindowWidth {0};
     int mWindowHeight {0};
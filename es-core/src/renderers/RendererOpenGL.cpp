@@ -19,6 +19,8 @@ RendererOpenGL::RendererOpenGL() noexcept
     , mShaderFBO2 {0}
     , mVertexBuffer1 {0}
     , mVertexBuffer2 {0}
+    , mPixelBuffers {0, 0}
+    , mPixelBufferIndex {0}
     , mSDLContext {nullptr}
     , mWhiteTexture {0}
     , mPostProcTexture1 {0}
@@ -277,6 +279,8 @@ bool RendererOpenGL::createContext()
     GL_CHECK_ERROR(glGenVertexArrays(1, &mVertexBuffer2));
     GL_CHECK_ERROR(glBindVertexArray(mVertexBuffer2));
 
+    GL_CHECK_ERROR(glGenBuffers(static_cast<GLsizei>(mPixelBuffers.size()), &mPixelBuffers[0]));
+
     uint8_t data[4] {255, 255, 255, 255};
     mWhiteTexture = createTexture(0, TextureType::BGRA, false, false, false, true, 1, 1, data);
 
@@ -315,6 +319,8 @@ void RendererOpenGL::destroyContext()
 {
     GL_CHECK_ERROR(glDeleteFramebuffers(1, &mShaderFBO1));
     GL_CHECK_ERROR(glDeleteFramebuffers(1, &mShaderFBO2));
+    GL_CHECK_ERROR(glDeleteBuffers(static_cast<GLsizei>(mPixelBuffers.size()), &mPixelBuffers[0]));
+    mPixelBuffers = {0, 0};
     destroyTexture(mPostProcTexture1);
     destroyTexture(mPostProcTexture2);
     destroyTexture(mWhiteTexture);
@@ -455,6 +461,12 @@ unsigned int RendererOpenGL::createTexture(const unsigned int texUnit,
     if (mipmapping)
         GL_CHECK_ERROR(glGenerateMipmap(GL_TEXTURE_2D));
 
+    if (data != nullptr) {
+        ++mRenderStatistics.textureUploads;
+        mRenderStatistics.textureUploadBytes +=
+            static_cast<size_t>(width * height * (type == TextureType::RED ? 1 : 4));
+    }
+
     return texture;
 }
 
@@ -480,7 +492,44 @@ void RendererOpenGL::updateTexture(const unsigned int texture,
     GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, textureType,
                                    GL_UNSIGNED_BYTE, data));
 
+    ++mRenderStatistics.textureUploads;
+    mRenderStatistics.textureUploadBytes +=
+        static_cast<size_t>(width * height * (type == TextureType::RED ? 1 : 4));
+
+    GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, mWhiteTexture));
+}
+
+void RendererOpenGL::streamTexture(const unsigned int texture,
+                                   const unsigned int texUnit,
+                                   const TextureType type,
+                                   const unsigned int width,
+                                   const unsigned int height,
+                                   void* data)
+{
+    assert(texUnit < 32);
+
+    const GLenum textureType {convertTextureType(type)};
+    const GLsizeiptr dataSize {
+        static_cast<GLsizeiptr>(width * height * (type == TextureType::RED ? 1 : 4))};
+
+    mPixelBufferIndex = (mPixelBufferIndex + 1) % mPixelBuffers.size();
+
+    // Respecifying the buffer storage orphans any previous storage which may still be in use
+    // by a pending transfer, so the driver never needs to stall here. The pixel data is copied
+    // to the buffer right away while the transfer to the texture takes place asynchronously.
+    GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPixelBuffers[mPixelBufferIndex]));
+    GL_CHECK_ERROR(glBufferData(GL_PIXEL_UNPACK_BUFFER, dataSize, data, GL_STREAM_DRAW));
+
+    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0 + texUnit));
+    GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture));
+    GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, textureType,
+                                   GL_UNSIGNED_BYTE, nullptr));
+
+    GL_CHECK_ERROR(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
     GL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, mWhiteTexture));
+
+    ++mRenderStatistics.textureUploads;
+    mRenderStatistics.textureUploadBytes += static_cast<size_t>(dataSize);
 }
 
 void RendererOpenGL::bindTexture(const unsigned int texture, const unsigned int texUnit)
@@ -503,6 +552,8 @@ void RendererOpenGL::drawTriangleStrips(const Vertex* vertices,
     const float width {vertices[3].position[0] - vertices[1].position[0]};
     const float height {vertices[3].position[1] - vertices[2].position[1]};
 
+    ++mRenderStatistics.drawCalls;
+
     GL_CHECK_ERROR(
         glBlendFunc(convertBlendFactor(srcBlendFactor), convertBlendFactor(dstBlendFactor)));
 
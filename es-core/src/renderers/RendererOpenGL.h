@@ -20,6 +20,7 @@
 #include <SDL2/SDL_opengl.h>
 #endif
 
+#include <array>
 #include <memory>
 
 class RendererOpenGL : public Renderer
@@ -61,6 +62,12 @@ public:
                        const unsigned int width,
                        const unsigned int height,
                        void* data) override;
+    void streamTexture(const unsigned int texture,
+                       const unsigned int texUnit,
+                       const TextureType type,
+                       const unsigned int width,
+                       const unsigned int height,
+                       void* data) override;
     void bindTexture(const unsigned int texture, const unsigned int texUnit) override;
     void drawTriangleStrips(
         const Vertex* vertices,
@@ -80,6 +87,9 @@ private:
     GLuint mShaderFBO2;
     GLuint mVertexBuffer1;
     GLuint mVertexBuffer2;
+    // Used alternately so that a new upload never has to wait for the previous transfer.
+    std::array<GLuint, 2> mPixelBuffers;
+    size_t mPixelBufferIndex;
 
     SDL_GLContext mSDLContext;
     GLuint mWhiteTexture;
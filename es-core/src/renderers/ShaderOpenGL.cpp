@@ -20,6 +20,7 @@ ShaderOpenGL::ShaderOpenGL()
     , mShaderColor {0}
     , mTextureSampler0 {0}
     , mTextureSampler1 {0}
+    , mTextureSampler2 {0}
     , mShaderTextureSize {0}
     , mShaderClipRegion {0}
     , mShaderBrightness {0}
@@ -128,6 +129,7 @@ void ShaderOpenGL::getVariableLocations(GLuint programID)
     mShaderColor = glGetAttribLocation(mProgramID, "colorVertex");
     mTextureSampler0 = glGetUniformLocation(mProgramID, "textureSampler0");
     mTextureSampler1 = glGetUniformLocation(mProgramID, "textureSampler1");
+    mTextureSampler2 = glGetUniformLocation(mProgramID, "textureSampler2");
     mShaderTextureSize = glGetUniformLocation(mProgramID, "texSize");
     mShaderClipRegion = glGetUniformLocation(mProgramID, "clipRegion");
     mShaderBrightness = glGetUniformLocation(mProgramID, "brightness");
@@ -170,6 +172,8 @@ void ShaderOpenGL::setTextureSamplers()
         GL_CHECK_ERROR(glUniform1i(mTextureSampler0, 0));
     if (mTextureSampler1 != -1)
         GL_CHECK_ERROR(glUniform1i(mTextureSampler1, 1));
+    if (mTextureSampler2 != -1)
+        GL_CHECK_ERROR(glUniform1i(mTextureSampler2, 2));
 }
 
 void ShaderOpenGL::setTextureSize(std::array<GLfloat, 2> shaderVec2)
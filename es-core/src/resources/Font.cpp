@@ -9,14 +9,25 @@
 #include "resources/Font.h"
 
 #include "Log.h"
+#include "Settings.h"
 #include "renderers/Renderer.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/PlatformUtil.h"
 #include "utils/StringUtil.h"
 
+#include FT_MODULE_H
+
 #define DEBUG_SHAPING false
 #define DISABLE_SHAPING false
 
+// Maximum number of entries in the shaped text cache.
+#define SHAPED_TEXT_CACHE_SIZE 1024
+
+// Signed distance field glyphs are rendered at this size and scaled to all other sizes.
+#define SDF_REFERENCE_SIZE 64.0f
+// Distance in pixels that is covered by the signed distance field on each side of the outline.
+#define SDF_SPREAD 8
+
 Font::Font(float size, const std::string& path)
     : mRenderer {Renderer::getInstance()}
     , mPath(path)
@@ -29,6 +40,7 @@ Font::Font(float size, const std::string& path)
     , mMaxGlyphHeight {static_cast<int>(std::round(size))}
     , mSpaceGlyph {0}
     , mShapeText {true}
+    , mSDF {Settings::getInstance()->getBool("FontSignedDistanceField")}
 {
     if (mFontSize < 3.0f) {
         mFontSize = 3.0f;
@@ -84,8 +96,19 @@ Font::~Font()
     hb_buffer_destroy(mBufHB);
     hb_font_destroy(mFontHB);
 
-    unload(ResourceManager::getInstance());
+    // The glyph atlas pages are shared with other fonts so they can't be unloaded here. Any
+    // glyphs for this font will be discarded when their pages get evicted.
 
+    // The shaped text refers to HarfBuzz fonts owned by this object so it must be removed.
+    for (auto it = sShapedTextLRU.begin(); it != sShapedTextLRU.end();) {
+        if (std::get<0>(**it) == this) {
+            sShapedTextMap.erase(**it);
+            it = sShapedTextLRU.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
     auto fontEntry = sFontMap.find(std::tuple<float, std::string>(mFontSize, mPath));
 
     if (fontEntry != sFontMap.cend())
@@ -97,12 +120,14 @@ Font::~Font()
         sFallbackFonts.clear();
         FT_Done_FreeType(sLibrary);
         sLibrary = nullptr;
+        sSDFGlyphMap.clear();
+        sGlyphAtlasManager.deletePages();
     }
 }
 
 std::shared_ptr<Font> Font::get(float size, const std::string& path)
 {
-    const std::string canonicalPath {Utils::FileSystem::getCanonicalPath(path)};
+    const std::string canonicalPath {Utils::FileSystem::getCachedCanonicalPath(path)};
     const std::tuple<float, std::string> def {size, canonicalPath.empty() ? getDefaultPath() :
                                                                             canonicalPath};
 
@@ -245,34 +270,6 @@ std::shared_ptr<Font> Font::getFromTheme(const ThemeData::ThemeElement* elem,
     return get(size, path);
 }
 
-size_t Font::getMemUsage() const
-{
-    size_t memUsage {0};
-
-    for (auto it = mTextures.cbegin(); it != mTextures.cend(); ++it)
-        memUsage += (*it)->textureSize.x * (*it)->textureSize.y * 4;
-
-    return memUsage;
-}
-
-size_t Font::getTotalMemUsage()
-{
-    size_t total {0};
-
-    auto it = sFontMap.cbegin();
-    while (it != sFontMap.cend()) {
-        if (it->second.expired()) {
-            it = sFontMap.erase(it);
-            continue;
-        }
-
-        total += it->second.lock()->getMemUsage();
-        ++it;
-    }
-
-    return total;
-}
-
 TextCache* Font::buildTextCache(const std::string& text,
                                 float length,
                                 float maxLength,
@@ -300,9 +297,8 @@ TextCache* Font::buildTextCache(const std::string& text,
         yBot = getHeight(lineSpacing);
     }
 
-    std::vector<ShapeSegment> segmentsHB;
-    shapeText(text, segmentsHB);
-    wrapText(segmentsHB, maxLength, height, lineSpacing, multiLine, needGlyphsPos);
+    const std::vector<ShapeSegment>& segmentsHB {
+        getShapedText(text, maxLength, height, lineSpacing, multiLine, needGlyphsPos)};
 
     size_t segmentIndex {0};
     float x {0.0f};
@@ -313,7 +309,9 @@ TextCache* Font::buildTextCache(const std::string& text,
     bool isNewLine {false};
 
     // Vertices by texture.
-    std::map<FontTexture*, std::vector<Renderer::Vertex>> vertMap;
+    // SDF glyphs and bitmap glyphs from fallback fonts may share atlas pages, so these are
+    // kept in separate vertex lists as only the SDF glyphs are rendered using the SDF shader.
+    std::map<std::pair<AtlasPage*, bool>, std::vector<Renderer::Vertex>> vertMap;
 
     std::vector<glm::vec2> glyphPositions;
     if (needGlyphsPos)
@@ -417,24 +415,27 @@ TextCache* Font::buildTextCache(const std::string& text,
 
             lineWidth += glyph->advance.x;
 
-            std::vector<Renderer::Vertex>& verts {vertMap[glyph->texture]};
+            std::vector<Renderer::Vertex>& verts {
+                vertMap[std::make_pair(glyph->texture, glyph->sdfGlyph != nullptr)]};
             size_t oldVertSize {verts.size()};
             verts.resize(oldVertSize + 6);
             Renderer::Vertex* vertices {verts.data() + oldVertSize};
 
             const float glyphStartX {x + glyph->bearing.x};
-            const glm::ivec2& textureSize {glyph->texture->textureSize};
+            // SDF glyphs are rasterized at a reference size and scaled to the font size.
+            const glm::vec2 glyphSize {
+                glyph->texSize.x * glyph->texture->textureSize.x * glyph->scale,
+                glyph->texSize.y * glyph->texture->textureSize.y * glyph->scale};
 
             vertices[1] = {
                 {glyphStartX, y - glyph->bearing.y}, {glyph->texPos.x, glyph->texPos.y}, color};
-            vertices[2] = {{glyphStartX, y - glyph->bearing.y + (glyph->texSize.y * textureSize.y)},
+            vertices[2] = {{glyphStartX, y - glyph->bearing.y + glyphSize.y},
                            {glyph->texPos.x, glyph->texPos.y + glyph->texSize.y},
                            color};
-            vertices[3] = {{glyphStartX + glyph->texSize.x * textureSize.x, y - glyph->bearing.y},
+            vertices[3] = {{glyphStartX + glyphSize.x, y - glyph->bearing.y},
                            {glyph->texPos.x + glyph->texSize.x, glyph->texPos.y},
                            color};
-            vertices[4] = {{glyphStartX + glyph->texSize.x * textureSize.x,
-                            y - glyph->bearing.y + (glyph->texSize.y * textureSize.y)},
+            vertices[4] = {{glyphStartX + glyphSize.x, y - glyph->bearing.y + glyphSize.y},
                            {glyph->texPos.x + glyph->texSize.x, glyph->texPos.y + glyph->texSize.y},
                            color};
 
@@ -469,7 +470,9 @@ TextCache* Font::buildTextCache(const std::string& text,
     size_t i {0};
     for (auto it = vertMap.cbegin(); it != vertMap.cend(); ++it) {
         TextCache::VertexList& vertList {cache->vertexLists.at(i)};
-        vertList.textureIdPtr = &it->first->textureId;
+        vertList.page = it->first.first;
+        vertList.generation = it->first.first->generation;
+        vertList.sdf = it->first.second;
         vertList.verts = it->second;
         ++i;
     }
@@ -487,16 +490,20 @@ void Font::renderTextCache(TextCache* cache)
     const bool clipRegion {cache->clipRegion != glm::vec4 {0.0f, 0.0f, 0.0f, 0.0f}};
 
     for (auto it = cache->vertexLists.begin(); it != cache->vertexLists.end(); ++it) {
-        assert(*it->textureIdPtr != 0);
+        assert(it->page->textureId != 0);
+        sGlyphAtlasManager.touchPage(it->page);
 
         it->verts[0].shaderFlags = Renderer::ShaderFlags::FONT_TEXTURE;
 
+        if (it->sdf)
+            it->verts[0].shaderFlags |= Renderer::ShaderFlags::SDF_FONT_TEXTURE;
+
         if (clipRegion) {
             it->verts[0].shaderFlags |= Renderer::ShaderFlags::CLIPPING;
             it->verts[0].clipRegion = cache->clipRegion;
         }
 
-        mRenderer->bindTexture(*it->textureIdPtr, 0);
+        mRenderer->bindTexture(it->page->textureId, 0);
         mRenderer->drawTriangleStrips(
             &it->verts[0], static_cast<const unsigned int>(it->verts.size()),
             Renderer::BlendFactor::SRC_ALPHA, Renderer::BlendFactor::ONE_MINUS_SRC_ALPHA);
@@ -535,70 +542,6 @@ float Font::getSizeReference()
     return mSizeReference;
 }
 
-Font::FontTexture::FontTexture(const int mFontSize)
-{
-    textureId = 0;
-    rowHeight = 0;
-    writePos = glm::ivec2 {1, 1};
-
-    // Set the glyph atlas to a reasonable size, if we run out of space for adding glyphs then
-    // more textures will be created dynamically.
-    textureSize = glm::ivec2 {mFontSize * 6, mFontSize * 6};
-}
-
-Font::FontTexture::~FontTexture()
-{
-    // Deinit the texture when destroyed.
-    deinitTexture();
-}
-
-bool Font::FontTexture::findEmpty(const glm::ivec2& size, glm::ivec2& cursorOut)
-{
-    if (size.x > textureSize.x || size.y > textureSize.y)
-        return false;
-
-    if (writePos.x + size.x + 1 > textureSize.x &&
-        writePos.y + rowHeight + size.y + 1 < textureSize.y) {
-        // Row is full, but the glyph should fit on the next row so move the cursor there.
-        // Leave 1 pixel of space between glyphs so that pixels from adjacent glyphs will not
-        // get sampled during scaling and interpolation, which would lead to edge artifacts.
-        writePos = glm::ivec2 {1, writePos.y + rowHeight + 1};
-        rowHeight = 0;
-    }
-
-    if (writePos.x + size.x + 1 > textureSize.x || writePos.y + size.y + 1 > textureSize.y)
-        return false; // No it still won't fit.
-
-    cursorOut = writePos;
-    // Leave 1 pixel of space between glyphs.
-    writePos.x += size.x + 1;
-
-    if (size.y > rowHeight)
-        rowHeight = size.y;
-
-    return true;
-}
-
-void Font::FontTexture::initTexture()
-{
-    assert(textureId == 0);
-    // Create a black texture with a zero alpha value so that single-pixel spaces between the
-    // glyphs will not be visible. That would otherwise lead to edge artifacts as these pixels
-    // would get sampled during scaling.
-    std::vector<uint8_t> texture(textureSize.x * textureSize.y * 4, 0);
-    textureId =
-        Renderer::getInstance()->createTexture(0, Renderer::TextureType::RED, true, true, false,
-                                               false, textureSize.x, textureSize.y, &texture[0]);
-}
-
-void Font::FontTexture::deinitTexture()
-{
-    if (textureId != 0) {
-        Renderer::getInstance()->destroyTexture(textureId);
-        textureId = 0;
-    }
-}
-
 Font::FontFace::FontFace(ResourceData&& d, float size, const std::string& path, hb_font_t* fontArg)
     : data {d}
 {
@@ -628,7 +571,13 @@ void Font::initLibrary()
     if (FT_Init_FreeType(&sLibrary)) {
         sLibrary = nullptr;
         LOG(LogError) << "Couldn't initialize FreeType";
+        return;
     }
+
+    // The default spread is too narrow for the glyphs to be scaled up by any larger factor.
+    FT_Int spread {SDF_SPREAD};
+    FT_Property_Set(sLibrary, "sdf", "spread", &spread);
+    FT_Property_Set(sLibrary, "bsdf", "spread", &spread);
 }
 
 void Font::shapeText(const std::string& text, std::vector<ShapeSegment>& segmentsHB)
@@ -1129,19 +1078,68 @@ void Font::wrapText(std::vector<ShapeSegment>& segmentsHB,
     std::swap(resultSegments, segmentsHB);
 }
 
+const std::vector<Font::ShapeSegment>& Font::getShapedText(const std::string& text,
+                                                         const float maxLength,
+                                                         const float maxHeight,
+                                                         const float lineSpacing,
+                                                         const bool multiLine,
+                                                         const bool needGlyphsPos)
+{
+    ShapedTextKeyType key {std::make_tuple(this, text, maxLength, maxHeight, lineSpacing,
+                                           multiLine, needGlyphsPos, mShapeText)};
+
+    auto it = sShapedTextMap.find(key);
+    if (it != sShapedTextMap.end()) {
+        ++sShapedTextHits;
+        // Move the entry to the front of the list.
+        sShapedTextLRU.splice(sShapedTextLRU.begin(), sShapedTextLRU, it->second.lruPosition);
+        return it->second.segments;
+    }
+
+    ++sShapedTextMisses;
+
+    std::vector<ShapeSegment> segmentsHB;
+    shapeText(text, segmentsHB);
+    wrapText(segmentsHB, maxLength, maxHeight, lineSpacing, multiLine, needGlyphsPos);
+
+    if (sShapedTextMap.size() >= SHAPED_TEXT_CACHE_SIZE) {
+        sShapedTextMap.erase(*sShapedTextLRU.back());
+        sShapedTextLRU.pop_back();
+    }
+
+    it = sShapedTextMap.emplace(std::move(key), ShapedText {}).first;
+    it->second.segments = std::move(segmentsHB);
+    sShapedTextLRU.emplace_front(&it->first);
+    it->second.lruPosition = sShapedTextLRU.begin();
+
+    return it->second.segments;
+}
+
 void Font::rebuildTextures()
 {
-    // Recreate all glyph atlas textures.
-    for (auto it = mTextures.begin(); it != mTextures.end(); ++it)
-        (*it)->initTexture();
+    // Recreate all glyph atlas textures, this only has an effect for the first font that
+    // gets reloaded as the pages are shared.
+    sGlyphAtlasManager.reloadPages();
 
     hb_font_t* returnedFont {nullptr};
 
     // Re-upload the texture data.
     for (auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); ++it) {
+        // Glyphs on evicted pages will be recreated when they are needed again.
+        if (!GlyphAtlasManager::isValid(it->second.texture, it->second.generation))
+            continue;
+
         FT_Face* face {getFaceForChar(it->first, &returnedFont)};
         FT_GlyphSlot glyphSlot {(*face)->glyph};
 
+        // SDF glyphs are shared between fonts so only upload these once.
+        if (it->second.sdfGlyph != nullptr) {
+            if (!it->second.sdfGlyph->uploaded)
+                rasterizeSDFGlyph(*it->second.sdfGlyph, face, FT_Get_Char_Index(*face, it->first),
+                                  true);
+            continue;
+        }
+
         // Load the glyph bitmap through FreeType.
         FT_Load_Char(*face, it->first, FT_LOAD_RENDER);
 
@@ -1159,10 +1157,19 @@ void Font::rebuildTextures()
     }
 
     for (auto it = mGlyphMapByIndex.cbegin(); it != mGlyphMapByIndex.cend(); ++it) {
+        if (!GlyphAtlasManager::isValid(it->second.texture, it->second.generation))
+            continue;
+
         FT_Face* face {
             getFaceForGlyphIndex(std::get<0>(it->first), std::get<1>(it->first), &returnedFont)};
         FT_GlyphSlot glyphSlot {(*face)->glyph};
 
+        if (it->second.sdfGlyph != nullptr) {
+            if (!it->second.sdfGlyph->uploaded)
+                rasterizeSDFGlyph(*it->second.sdfGlyph, face, std::get<0>(it->first), true);
+            continue;
+        }
+
         FT_Load_Glyph(*face, std::get<0>(it->first), FT_LOAD_RENDER);
 
         const glm::ivec2 glyphSize {glyphSlot->bitmap.width, glyphSlot->bitmap.rows};
@@ -1180,32 +1187,10 @@ void Font::rebuildTextures()
 
 void Font::unloadTextures()
 {
-    for (auto it = mTextures.begin(); it != mTextures.end(); ++it)
-        (*it)->deinitTexture();
-}
-
-void Font::getTextureForNewGlyph(const glm::ivec2& glyphSize,
-                                 FontTexture*& texOut,
-                                 glm::ivec2& cursorOut)
-{
-    if (mTextures.size()) {
-        // Check if the most recent texture has space available for the glyph.
-        texOut = mTextures.back().get();
+    for (auto& sdfGlyph : sSDFGlyphMap)
+        sdfGlyph.second.uploaded = false;
 
-        // Will this one work?
-        if (texOut->findEmpty(glyphSize, cursorOut))
-            return; // Yes.
-    }
-
-    mTextures.emplace_back(std::make_unique<FontTexture>(static_cast<int>(std::round(mFontSize))));
-    texOut = mTextures.back().get();
-    texOut->initTexture();
-
-    if (!texOut->findEmpty(glyphSize, cursorOut)) {
-        LOG(LogError) << "Glyph too big to fit on a new texture (glyph size > "
-                      << texOut->textureSize.x << ", " << texOut->textureSize.y << ")";
-        texOut = nullptr;
-    }
+    sGlyphAtlasManager.unloadPages();
 }
 
 std::vector<Font::FallbackFontCache> Font::getFallbackFontPaths()
@@ -1297,13 +1282,123 @@ FT_Face* Font::getFaceForGlyphIndex(unsigned int id, hb_font_t* fontArg, hb_font
     return &mFontFace->face;
 }
 
+const std::string& Font::getFacePath(hb_font_t* fontHB)
+{
+    for (auto& font : sFallbackFonts) {
+        if (font.fontHB == fontHB)
+            return font.path;
+    }
+
+    return mPath;
+}
+
+bool Font::setSDFGlyph(Glyph& glyph,
+                       FT_Face* face,
+                       const unsigned int glyphIndex,
+                       hb_font_t* fontHB)
+{
+    SDFGlyph& sdfGlyph {sSDFGlyphMap[std::make_pair(getFacePath(fontHB), glyphIndex)]};
+
+    if (!GlyphAtlasManager::isValid(sdfGlyph.texture, sdfGlyph.generation)) {
+        if (!rasterizeSDFGlyph(sdfGlyph, face, glyphIndex, false))
+            return false;
+    }
+    else if (!sdfGlyph.uploaded) {
+        if (!rasterizeSDFGlyph(sdfGlyph, face, glyphIndex, true))
+            return false;
+    }
+
+    sGlyphAtlasManager.touchPage(sdfGlyph.texture);
+
+    const float scale {mFontSize / SDF_REFERENCE_SIZE};
+
+    glyph.texture = sdfGlyph.texture;
+    glyph.generation = sdfGlyph.generation;
+    glyph.texPos = sdfGlyph.texPos;
+    glyph.texSize = sdfGlyph.texSize;
+    glyph.bearing = {static_cast<int>(std::round(sdfGlyph.bearing.x * scale)),
+                     static_cast<int>(std::round(sdfGlyph.bearing.y * scale))};
+    glyph.scale = scale;
+    glyph.sdfGlyph = &sdfGlyph;
+
+    return true;
+}
+
+bool Font::rasterizeSDFGlyph(SDFGlyph& sdfGlyph,
+                             FT_Face* face,
+                             const unsigned int glyphIndex,
+                             const bool reupload)
+{
+    const FT_GlyphSlot glyphSlot {(*face)->glyph};
+    bool success {true};
+
+    FT_Set_Char_Size(*face, static_cast<FT_F26Dot6>(0.0f),
+                     static_cast<FT_F26Dot6>(SDF_REFERENCE_SIZE * 64.0f), 0, 0);
+
+    // Glyphs without outlines (i.e. bitmap fonts) can't be rendered as distance fields.
+    if (FT_Load_Glyph(*face, glyphIndex, FT_LOAD_NO_HINTING) != 0 ||
+        glyphSlot->format != FT_GLYPH_FORMAT_OUTLINE) {
+        success = false;
+    }
+    // Empty glyphs such as spaces can't be rendered but they still need an atlas entry.
+    else if (glyphSlot->outline.n_points > 0 &&
+             FT_Render_Glyph(glyphSlot, FT_RENDER_MODE_SDF) != 0) {
+        success = false;
+    }
+
+    if (success) {
+        const glm::ivec2 glyphSize {
+            glyphSlot->format == FT_GLYPH_FORMAT_BITMAP ? glyphSlot->bitmap.width : 0,
+            glyphSlot->format == FT_GLYPH_FORMAT_BITMAP ? glyphSlot->bitmap.rows : 0};
+        glm::ivec2 cursor {0, 0};
+
+        if (reupload) {
+            cursor = {static_cast<int>(sdfGlyph.texPos.x * sdfGlyph.texture->textureSize.x),
+                      static_cast<int>(sdfGlyph.texPos.y * sdfGlyph.texture->textureSize.y)};
+        }
+        else {
+            AtlasPage* tex {sGlyphAtlasManager.getPageForGlyph(glyphSize, cursor)};
+            if (tex == nullptr) {
+                success = false;
+            }
+            else {
+                sdfGlyph.texture = tex;
+                sdfGlyph.generation = tex->generation;
+                sdfGlyph.texPos = {cursor.x / static_cast<float>(tex->textureSize.x),
+                                   cursor.y / static_cast<float>(tex->textureSize.y)};
+                sdfGlyph.texSize = {glyphSize.x / static_cast<float>(tex->textureSize.x),
+                                    glyphSize.y / static_cast<float>(tex->textureSize.y)};
+                sdfGlyph.bearing = {glyphSlot->bitmap_left, glyphSlot->bitmap_top};
+            }
+        }
+
+        if (success && glyphSize.x > 0 && glyphSize.y > 0) {
+            mRenderer->updateTexture(sdfGlyph.texture->textureId, 0, Renderer::TextureType::RED,
+                                     cursor.x, cursor.y, glyphSize.x, glyphSize.y,
+                                     glyphSlot->bitmap.buffer);
+        }
+
+        sdfGlyph.uploaded = success;
+    }
+
+    FT_Set_Char_Size(*face, static_cast<FT_F26Dot6>(0.0f),
+                     static_cast<FT_F26Dot6>(mFontSize * 64.0f), 0, 0);
+
+    return success;
+}
+
 Font::Glyph* Font::getGlyph(const unsigned int id)
 {
-    // Check if the glyph has already been loaded.
+    // Check if the glyph has already been loaded and that its atlas page has not been evicted.
     auto it = mGlyphMap.find(id);
-    if (it != mGlyphMap.cend())
+    if (it != mGlyphMap.cend() &&
+        GlyphAtlasManager::isValid(it->second.texture, it->second.generation)) {
+        sGlyphAtlasManager.touchPage(it->second.texture);
+        sGlyphAtlasManager.registerHit();
         return &it->second;
+    }
 
+    sGlyphAtlasManager.registerMiss();
     hb_font_t* returnedFont {nullptr};
 
     // We need to create a new entry.
@@ -1316,16 +1411,28 @@ Font::Glyph* Font::getGlyph(const unsigned int id)
 
     const FT_GlyphSlot glyphSlot {(*face)->glyph};
 
+    if (mSDF && FT_Load_Char(*face, id, FT_LOAD_DEFAULT) == 0) {
+        // Only the metrics are needed at the actual font size as the glyph itself is shared
+        // between all font sizes.
+        Glyph& glyph {mGlyphMap[id]};
+        glyph.fontHB = returnedFont;
+        glyph.advance = {glyphSlot->metrics.horiAdvance >> 6, glyphSlot->metrics.vertAdvance >> 6};
+        glyph.rows = static_cast<int>(std::ceil(glyphSlot->metrics.height / 64.0f));
+
+        if (setSDFGlyph(glyph, face, FT_Get_Char_Index(*face, id), returnedFont))
+            return &glyph;
+        // Otherwise fall back to a regular glyph, which is required for bitmap fonts.
+    }
+
     if (FT_Load_Char(*face, id, FT_LOAD_RENDER)) {
         LOG(LogError) << "Couldn't find glyph for character " << id << " for font " << mPath
                       << ", size " << mFontSize;
         return nullptr;
     }
 
-    FontTexture* tex {nullptr};
     glm::ivec2 cursor {0, 0};
     const glm::ivec2 glyphSize {glyphSlot->bitmap.width, glyphSlot->bitmap.rows};
-    getTextureForNewGlyph(glyphSize, tex, cursor);
+    AtlasPage* tex {sGlyphAtlasManager.getPageForGlyph(glyphSize, cursor)};
 
     // This should (hopefully) never occur as size constraints are enforced earlier on.
     if (tex == nullptr) {
@@ -1339,6 +1446,7 @@ Font::Glyph* Font::getGlyph(const unsigned int id)
 
     glyph.fontHB = returnedFont;
     glyph.texture = tex;
+    glyph.generation = tex->generation;
     glyph.texPos = {cursor.x / static_cast<float>(tex->textureSize.x),
                     cursor.y / static_cast<float>(tex->textureSize.y)};
     glyph.texSize = {glyphSize.x / static_cast<float>(tex->textureSize.x),
@@ -1346,6 +1454,8 @@ Font::Glyph* Font::getGlyph(const unsigned int id)
     glyph.advance = {glyphSlot->metrics.horiAdvance >> 6, glyphSlot->metrics.vertAdvance >> 6};
     glyph.bearing = {glyphSlot->metrics.horiBearingX >> 6, glyphSlot->metrics.horiBearingY >> 6};
     glyph.rows = glyphSize.y;
+    glyph.scale = 1.0f;
+    glyph.sdfGlyph = nullptr;
 
     // Upload glyph bitmap to glyph atlas texture.
     if (glyphSize.x > 0 && glyphSize.y > 0) {
@@ -1358,11 +1468,16 @@ Font::Glyph* Font::getGlyph(const unsigned int id)
 
 Font::Glyph* Font::getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, int xAdvance)
 {
-    // Check if the glyph has already been loaded.
+    // Check if the glyph has already been loaded and that its atlas page has not been evicted.
     auto it = mGlyphMapByIndex.find(std::make_tuple(id, fontArg, xAdvance));
-    if (it != mGlyphMapByIndex.end())
+    if (it != mGlyphMapByIndex.end() &&
+        GlyphAtlasManager::isValid(it->second.texture, it->second.generation)) {
+        sGlyphAtlasManager.touchPage(it->second.texture);
+        sGlyphAtlasManager.registerHit();
         return &it->second;
+    }
 
+    sGlyphAtlasManager.registerMiss();
     hb_font_t* returnedFont {nullptr};
 
     // We need to create a new entry.
@@ -1375,27 +1490,40 @@ Font::Glyph* Font::getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, in
 
     const FT_GlyphSlot glyphSlot {(*face)->glyph};
 
+    if (mSDF && FT_Load_Glyph(*face, id, FT_LOAD_DEFAULT) == 0) {
+        Glyph& glyph {mGlyphMapByIndex[std::make_tuple(id, returnedFont, xAdvance)]};
+        glyph.fontHB = returnedFont;
+        glyph.advance = {xAdvance, glyphSlot->metrics.vertAdvance >> 6};
+        glyph.rows = static_cast<int>(std::ceil(glyphSlot->metrics.height / 64.0f));
+
+        if (setSDFGlyph(glyph, face, id, returnedFont))
+            return &glyph;
+    }
+
     if (FT_Load_Glyph(*face, id, FT_LOAD_RENDER)) {
         LOG(LogError) << "Couldn't find glyph for glyph index " << id << " for font " << mPath
                       << ", size " << mFontSize;
         return nullptr;
     }
 
-    FontTexture* tex {nullptr};
+    AtlasPage* tex {nullptr};
     glm::ivec2 cursor {0, 0};
     const glm::ivec2 glyphSize {glyphSlot->bitmap.width, glyphSlot->bitmap.rows};
 
     // Check if there is already a texture entry for the glyph, otherwise create it.
     // This makes sure we don't create multiple identical glyph atlas entries and waste VRAM.
     auto it2 = mGlyphTextureMap.find(std::make_pair(id, fontArg));
-    if (it2 != mGlyphTextureMap.end()) {
+    if (it2 != mGlyphTextureMap.end() &&
+        GlyphAtlasManager::isValid((*it2).second.texture, (*it2).second.generation)) {
         tex = (*it2).second.texture;
         cursor = (*it2).second.cursor;
+        sGlyphAtlasManager.touchPage(tex);
     }
     else {
-        getTextureForNewGlyph(glyphSize, tex, cursor);
+        tex = sGlyphAtlasManager.getPageForGlyph(glyphSize, cursor);
         GlyphTexture& glyphTexture {mGlyphTextureMap[std::make_pair(id, returnedFont)]};
         glyphTexture.texture = tex;
+        glyphTexture.generation = (tex == nullptr ? 0 : tex->generation);
         glyphTexture.cursor = cursor;
     }
 
@@ -1411,6 +1539,7 @@ Font::Glyph* Font::getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, in
 
     glyph.fontHB = returnedFont;
     glyph.texture = tex;
+    glyph.generation = tex->generation;
     glyph.texPos = {cursor.x / static_cast<float>(tex->textureSize.x),
                     cursor.y / static_cast<float>(tex->textureSize.y)};
     glyph.texSize = {glyphSize.x / static_cast<float>(tex->textureSize.x),
@@ -1418,6 +1547,8 @@ Font::Glyph* Font::getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, in
     glyph.advance = {xAdvance, glyphSlot->metrics.vertAdvance >> 6};
     glyph.bearing = {glyphSlot->metrics.horiBearingX >> 6, glyphSlot->metrics.horiBearingY >> 6};
     glyph.rows = glyphSize.y;
+    glyph.scale = 1.0f;
+    glyph.sdfGlyph = nullptr;
 
     // Upload glyph bitmap to glyph atlas texture.
     if (glyphSize.x > 0 && glyphSize.y > 0) {
@@ -1428,6 +1559,16 @@ Font::Glyph* Font::getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, in
     return &glyph;
 }
 
+bool TextCache::isValid() const
+{
+    for (auto it = vertexLists.cbegin(); it != vertexLists.cend(); ++it) {
+        if (!GlyphAtlasManager::isValid(it->page, it->generation))
+            return false;
+    }
+
+    return true;
+}
+
 void TextCache::setColor(unsigned int color)
 {
     for (auto it = vertexLists.begin(); it != vertexLists.end(); ++it)
@@ -12,11 +12,13 @@
 #include "GuiComponent.h"
 #include "ThemeData.h"
 #include "renderers/Renderer.h"
+#include "resources/GlyphAtlasManager.h"
 #include "resources/ResourceManager.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <hb-ft.h>
+#include <list>
 #include <vector>
 
 class TextComponent;
@@ -124,10 +126,26 @@ public:
                                               const float sizeMultiplier = 1.0f,
                                               const bool fontSizeDimmed = false);
 
-    // Returns an approximation of VRAM used by the glyph atlas textures for this font object.
-    size_t getMemUsage() const;
     // Returns an approximation of VRAM used by the glyph atlas textures for all font objects.
-    static size_t getTotalMemUsage();
+    static size_t getTotalMemUsage() { return sGlyphAtlasManager.getMemUsage(); }
+    // Returns glyph cache hits and misses as well as glyph atlas occupancy.
+    static const GlyphAtlasManager::Statistics getGlyphAtlasStatistics()
+    {
+        return sGlyphAtlasManager.getStatistics();
+    }
+    // Needs to be called once per frame as glyph atlas eviction is based on frame usage.
+    static void nextFrame() { sGlyphAtlasManager.nextFrame(); }
+
+    struct ShapedTextCacheStatistics {
+        size_t entries;
+        unsigned long hits;
+        unsigned long misses;
+    };
+    static const ShapedTextCacheStatistics getShapedTextCacheStatistics()
+    {
+        return ShapedTextCacheStatistics {sShapedTextMap.size(), sShapedTextHits,
+                                          sShapedTextMisses};
+    }
 
 protected:
     TextCache* buildTextCache(const std::string& text,
@@ -155,23 +173,6 @@ private:
     Font(float size, const std::string& path);
     static void initLibrary();
 
-    struct FontTexture {
-        unsigned int textureId;
-        glm::ivec2 textureSize;
-        glm::ivec2 writePos;
-        int rowHeight;
-
-        FontTexture(const int mFontSize);
-        ~FontTexture();
-        bool findEmpty(const glm::ivec2& size, glm::ivec2& cursorOut);
-
-        // You must call initTexture() after creating a FontTexture to get a textureId.
-        void initTexture();
-
-        // Deinitializes all glyph atlas textures.
-        void deinitTexture();
-    };
-
     struct FontFace {
         const ResourceData data;
         FT_Face face;
@@ -181,18 +182,46 @@ private:
         virtual ~FontFace();
     };
 
+    using AtlasPage = GlyphAtlasManager::AtlasPage;
+
+    // Signed distance field glyph, rasterized once per font face at a reference size and
+    // shared by all font sizes.
+    struct SDFGlyph {
+        AtlasPage* texture;
+        unsigned int generation;
+        glm::vec2 texPos;
+        glm::vec2 texSize;
+        glm::ivec2 bearing;
+        bool uploaded;
+
+        SDFGlyph()
+            : texture {nullptr}
+            , generation {0}
+            , texPos {0.0f, 0.0f}
+            , texSize {0.0f, 0.0f}
+            , bearing {0, 0}
+            , uploaded {false}
+        {
+        }
+    };
+
     struct Glyph {
-        FontTexture* texture;
+        AtlasPage* texture;
+        unsigned int generation;
         hb_font_t* fontHB;
         glm::vec2 texPos;
         glm::vec2 texSize;
         glm::ivec2 advance;
         glm::ivec2 bearing;
         int rows;
+        // Scale factor from the atlas entry to the rendered size, only used for SDF glyphs.
+        float scale;
+        SDFGlyph* sdfGlyph;
     };
 
     struct GlyphTexture {
-        FontTexture* texture;
+        AtlasPage* texture;
+        unsigned int generation;
         glm::ivec2 cursor;
     };
 
@@ -241,28 +270,65 @@ private:
                   const bool multiLine,
                   const bool needGlyphsPos);
 
+    // Returns shaped and wrapped text, either from the shaped text cache or by running
+    // shapeText() and wrapText(). The returned reference is only valid until the next call.
+    const std::vector<ShapeSegment>& getShapedText(const std::string& text,
+                                                   const float maxLength,
+                                                   const float maxHeight,
+                                                   const float lineSpacing,
+                                                   const bool multiLine,
+                                                   const bool needGlyphsPos);
+
     // Completely recreate the texture data for all glyph atlas entries.
     void rebuildTextures();
     void unloadTextures();
 
-    void getTextureForNewGlyph(const glm::ivec2& glyphSize,
-                               FontTexture*& texOut,
-                               glm::ivec2& cursorOut);
-
     std::vector<FallbackFontCache> getFallbackFontPaths();
     FT_Face* getFaceForChar(unsigned int id, hb_font_t** returnedFont);
     FT_Face* getFaceForGlyphIndex(unsigned int id, hb_font_t* fontArg, hb_font_t** returnedFont);
     Glyph* getGlyph(const unsigned int id);
     Glyph* getGlyphByIndex(const unsigned int id, hb_font_t* fontArg, int xAdvance);
 
+    // Returns the file path of the face belonging to the HarfBuzz font, used as key for the
+    // SDF glyphs which are shared between all sizes of the same font.
+    const std::string& getFacePath(hb_font_t* fontHB);
+    // Assigns the shared SDF atlas entry to the glyph, rasterizing it if required.
+    bool setSDFGlyph(Glyph& glyph,
+                     FT_Face* face,
+                     const unsigned int glyphIndex,
+                     hb_font_t* fontHB);
+    // Renders an SDF glyph at the reference size and uploads it to the glyph atlas.
+    bool rasterizeSDFGlyph(SDFGlyph& sdfGlyph,
+                           FT_Face* face,
+                           const unsigned int glyphIndex,
+                           const bool reupload);
+
     static inline FT_Library sLibrary {nullptr};
     static inline std::map<std::tuple<float, std::string>, std::weak_ptr<Font>> sFontMap;
     static inline std::vector<FallbackFontCache> sFallbackFonts;
     static inline std::map<hb_font_t*, unsigned int> sFallbackSpaceGlyphs;
+    // The glyph atlas textures are shared between all font objects.
+    static inline GlyphAtlasManager sGlyphAtlasManager;
+
+    // Font, text, max length, max height, line spacing, multiline, glyph positions, shaping.
+    using ShapedTextKeyType =
+        std::tuple<const Font*, std::string, float, float, float, bool, bool, bool>;
+    struct ShapedText {
+        std::vector<ShapeSegment> segments;
+        std::list<const ShapedTextKeyType*>::iterator lruPosition;
+    };
+    // Least recently used cache of shaped and wrapped text, shared between all font objects.
+    // The most recently used entries are at the front of the list.
+    static inline std::map<ShapedTextKeyType, ShapedText> sShapedTextMap;
+    static inline std::list<const ShapedTextKeyType*> sShapedTextLRU;
+    static inline unsigned long sShapedTextHits {0};
+    static inline unsigned long sShapedTextMisses {0};
+
+    // Font face path and glyph index.
+    static inline std::map<std::pair<std::string, unsigned int>, SDFGlyph> sSDFGlyphMap;
 
     Renderer* mRenderer;
     std::unique_ptr<FontFace> mFontFace;
-    std::vector<std::unique_ptr<FontTexture>> mTextures;
     std::map<unsigned int, Glyph> mGlyphMap;
     std::map<std::tuple<unsigned int, hb_font_t*, int>, Glyph> mGlyphMapByIndex;
     std::map<std::pair<unsigned int, hb_font_t*>, GlyphTexture> mGlyphTextureMap;
@@ -278,6 +344,7 @@ private:
     int mMaxGlyphHeight;
     unsigned int mSpaceGlyph;
     bool mShapeText;
+    bool mSDF;
 };
 
 // Caching of shaped and rendered text.
@@ -300,6 +367,10 @@ public:
     void setClipRegion(const glm::vec4& clip) { clipRegion = clip; }
     const glm::vec2& getSize() { return metrics.size; }
 
+    // Returns false if any glyph atlas page used by the cache has been evicted, in which case
+    // the cache needs to be rebuilt.
+    bool isValid() const;
+
     // Used by TextEditComponent to position the cursor and scroll the text box.
     std::vector<glm::vec2> glyphPositions;
 
@@ -308,7 +379,10 @@ public:
 protected:
     struct VertexList {
         std::vector<Renderer::Vertex> verts;
-        unsigned int* textureIdPtr;
+        GlyphAtlasManager::AtlasPage* page;
+        unsigned int generation;
+        // Whether the glyphs are signed distance fields rather than coverage bitmaps.
+        bool sdf;
     };
 
     std::vector<VertexList> vertexLists;
@@ -0,0 +1,300 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  GlyphAtlasManager.cpp
+//
+//  Glyph atlas textures shared by all Font objects.
+//  When the memory cap has been reached the least recently used atlas page is cleared
+//  and reused, and any glyphs and text caches referring to it are recreated on demand.
+//
+
+#include "resources/GlyphAtlasManager.h"
+
+#include "Log.h"
+#include "renderers/Renderer.h"
+
+#include <algorithm>
+
+#define DEBUG_GLYPH_ATLAS false
+
+// Size of a regular atlas page, glyphs larger than this get a dedicated page.
+#define ATLAS_PAGE_SIZE 1024
+// The memory cap in MiB for all atlas pages combined.
+#define ATLAS_MAX_VRAM 32
+// The atlas pages are single-channel textures.
+#define ATLAS_BYTES_PER_PIXEL 1
+// Shelf heights are rounded up to a multiple of this value so that glyphs of similar
+// heights (including from different fonts of similar size) are packed together.
+#define SHELF_HEIGHT_ALIGNMENT 8
+
+GlyphAtlasManager::AtlasPage::AtlasPage(const glm::ivec2& size)
+    : textureId {0}
+    , textureSize {size}
+    , generation {0}
+    , lastUsedFrame {0}
+    , usedArea {0}
+    , active {true}
+    , mNextShelfPosY {1}
+{
+}
+
+GlyphAtlasManager::AtlasPage::~AtlasPage()
+{
+    // Deinit the texture when destroyed.
+    deinitTexture();
+}
+
+bool GlyphAtlasManager::AtlasPage::findEmpty(const glm::ivec2& size, glm::ivec2& cursorOut)
+{
+    // Leave 1 pixel of space between glyphs so that pixels from adjacent glyphs will not
+    // get sampled during scaling and interpolation, which would lead to edge artifacts.
+    if (size.x + 2 > textureSize.x || size.y + 2 > textureSize.y)
+        return false;
+
+    const int alignedHeight {((size.y + SHELF_HEIGHT_ALIGNMENT - 1) / SHELF_HEIGHT_ALIGNMENT) *
+                             SHELF_HEIGHT_ALIGNMENT};
+    Shelf* bestShelf {nullptr};
+
+    for (auto& shelf : mShelves) {
+        if (shelf.height < size.y || shelf.writePosX + size.x + 1 > textureSize.x)
+            continue;
+        // Don't put small glyphs on much taller shelves as that would waste a lot of space.
+        if (shelf.height > alignedHeight * 2)
+            continue;
+        if (bestShelf == nullptr || shelf.height < bestShelf->height)
+            bestShelf = &shelf;
+    }
+
+    if (bestShelf == nullptr) {
+        if (mNextShelfPosY + size.y + 1 > textureSize.y)
+            return false; // The page is full.
+
+        Shelf shelf;
+        shelf.posY = mNextShelfPosY;
+        shelf.height = std::min(alignedHeight, textureSize.y - mNextShelfPosY - 1);
+        shelf.writePosX = 1;
+        mNextShelfPosY += shelf.height + 1;
+        mShelves.emplace_back(shelf);
+        bestShelf = &mShelves.back();
+    }
+
+    cursorOut = glm::ivec2 {bestShelf->writePosX, bestShelf->posY};
+    bestShelf->writePosX += size.x + 1;
+    usedArea += static_cast<size_t>(size.x * size.y);
+
+    return true;
+}
+
+void GlyphAtlasManager::AtlasPage::clear()
+{
+    mShelves.clear();
+    mNextShelfPosY = 1;
+    usedArea = 0;
+    ++generation;
+
+    if (textureId != 0) {
+        std::vector<uint8_t> texture(textureSize.x * textureSize.y, 0);
+        Renderer::getInstance()->updateTexture(textureId, 0, Renderer::TextureType::RED, 0, 0,
+                                               textureSize.x, textureSize.y, &texture[0]);
+    }
+}
+
+void GlyphAtlasManager::AtlasPage::initTexture()
+{
+    assert(textureId == 0);
+    // Create a black texture with a zero alpha value so that single-pixel spaces between the
+    // glyphs will not be visible. That would otherwise lead to edge artifacts as these pixels
+    // would get sampled during scaling.
+    std::vector<uint8_t> texture(textureSize.x * textureSize.y * ATLAS_BYTES_PER_PIXEL, 0);
+    textureId =
+        Renderer::getInstance()->createTexture(0, Renderer::TextureType::RED, true, true, false,
+                                               false, textureSize.x, textureSize.y, &texture[0]);
+}
+
+void GlyphAtlasManager::AtlasPage::deinitTexture()
+{
+    if (textureId != 0) {
+        Renderer::getInstance()->destroyTexture(textureId);
+        textureId = 0;
+    }
+}
+
+GlyphAtlasManager::GlyphAtlasManager()
+    : mFrameCount {1}
+    , mGlyphHits {0}
+    , mGlyphMisses {0}
+    , mPageEvictions {0}
+{
+}
+
+GlyphAtlasManager::AtlasPage* GlyphAtlasManager::getPageForGlyph(const glm::ivec2& glyphSize,
+                                                                 glm::ivec2& cursorOut)
+{
+    // Check the most recently used pages first as these are the most likely ones to contain
+    // glyphs for the same font.
+    AtlasPage* page {nullptr};
+    for (auto it = mPages.rbegin(); it != mPages.rend(); ++it) {
+        if ((*it)->active && (*it)->findEmpty(glyphSize, cursorOut)) {
+            page = (*it).get();
+            break;
+        }
+    }
+
+    if (page == nullptr) {
+        const glm::ivec2 pageSize {std::max(ATLAS_PAGE_SIZE, glyphSize.x + 2),
+                                   std::max(ATLAS_PAGE_SIZE, glyphSize.y + 2)};
+        const size_t pageMemUsage {
+            static_cast<size_t>(pageSize.x * pageSize.y * ATLAS_BYTES_PER_PIXEL)};
+        const size_t maxMemUsage {static_cast<size_t>(ATLAS_MAX_VRAM) * 1024 * 1024};
+
+        // Prefer reusing a page that was previously released, otherwise evict the least
+        // recently used page if a new page would exceed the memory cap. Pages that have been
+        // used during the current frame are never evicted as the glyphs on these may already
+        // have been rendered or added to a text cache.
+        AtlasPage* inactivePage {nullptr};
+        AtlasPage* evictPageCandidate {nullptr};
+        for (auto& atlasPage : mPages) {
+            if (!atlasPage->active) {
+                if (inactivePage == nullptr)
+                    inactivePage = atlasPage.get();
+            }
+            else if (atlasPage->lastUsedFrame != mFrameCount &&
+                     (evictPageCandidate == nullptr ||
+                      atlasPage->lastUsedFrame < evictPageCandidate->lastUsedFrame)) {
+                evictPageCandidate = atlasPage.get();
+            }
+        }
+
+        if (getMemUsage() + pageMemUsage > maxMemUsage && evictPageCandidate != nullptr) {
+            evictPage(evictPageCandidate);
+            page = evictPageCandidate;
+        }
+        else if (inactivePage != nullptr) {
+            page = inactivePage;
+            page->active = true;
+        }
+        else {
+            mPages.emplace_back(std::make_unique<AtlasPage>(pageSize));
+            page = mPages.back().get();
+        }
+
+        // A recycled page may have a different size than what is needed for this glyph.
+        if (page->textureSize != pageSize) {
+            page->deinitTexture();
+            page->textureSize = pageSize;
+        }
+
+        if (page->textureId == 0)
+            page->initTexture();
+
+        if (!page->findEmpty(glyphSize, cursorOut)) {
+            LOG(LogError) << "Glyph too big to fit on a new glyph atlas page (glyph size > "
+                          << page->textureSize.x << ", " << page->textureSize.y << ")";
+            return nullptr;
+        }
+
+#if (DEBUG_GLYPH_ATLAS)
+        LOG(LogDebug) << "GlyphAtlasManager::getPageForGlyph(): Now using " << mPages.size()
+                      << " pages with a total size of " << getMemUsage() / 1024 << " KiB";
+#endif
+    }
+
+    touchPage(page);
+    return page;
+}
+
+void GlyphAtlasManager::nextFrame()
+{
+    ++mFrameCount;
+
+    const size_t maxMemUsage {static_cast<size_t>(ATLAS_MAX_VRAM) * 1024 * 1024};
+    size_t memUsage {getMemUsage()};
+
+    if (memUsage <= maxMemUsage)
+        return;
+
+    // If all pages were in use when a new page was needed (which can happen while loading a
+    // theme as no frames are rendered at that point) the memory cap would have been exceeded.
+    // In this case release the least recently used pages until we're within the cap again.
+    while (memUsage > maxMemUsage) {
+        AtlasPage* releasePage {nullptr};
+        for (auto& page : mPages) {
+            if (page->active && page->lastUsedFrame < mFrameCount - 1 &&
+                (releasePage == nullptr || page->lastUsedFrame < releasePage->lastUsedFrame))
+                releasePage = page.get();
+        }
+
+        if (releasePage == nullptr)
+            break;
+
+        evictPage(releasePage);
+        releasePage->deinitTexture();
+        releasePage->active = false;
+        memUsage = getMemUsage();
+    }
+}
+
+void GlyphAtlasManager::reloadPages()
+{
+    // Each Font object re-uploads its own glyphs after this.
+    for (auto& page : mPages) {
+        if (page->active && page->textureId == 0)
+            page->initTexture();
+    }
+}
+
+void GlyphAtlasManager::unloadPages()
+{
+    for (auto& page : mPages)
+        page->deinitTexture();
+}
+
+size_t GlyphAtlasManager::getMemUsage() const
+{
+    size_t memUsage {0};
+
+    for (auto& page : mPages) {
+        if (page->active && page->textureId != 0)
+            memUsage += static_cast<size_t>(page->textureSize.x * page->textureSize.y *
+                                            ATLAS_BYTES_PER_PIXEL);
+    }
+
+    return memUsage;
+}
+
+const GlyphAtlasManager::Statistics GlyphAtlasManager::getStatistics() const
+{
+    Statistics statistics;
+    size_t usedArea {0};
+
+    statistics.pageCount = 0;
+    statistics.memUsage = getMemUsage();
+    statistics.glyphHits = mGlyphHits;
+    statistics.glyphMisses = mGlyphMisses;
+    statistics.pageEvictions = mPageEvictions;
+
+    for (auto& page : mPages) {
+        if (!page->active || page->textureId == 0)
+            continue;
+        ++statistics.pageCount;
+        usedArea += page->usedArea;
+    }
+
+    statistics.occupancy = (statistics.memUsage == 0 ?
+                                0.0f :
+                                static_cast<float>(usedArea * ATLAS_BYTES_PER_PIXEL) /
+                                    static_cast<float>(statistics.memUsage));
+
+    return statistics;
+}
+
+void GlyphAtlasManager::evictPage(AtlasPage* page)
+{
+#if (DEBUG_GLYPH_ATLAS)
+    LOG(LogDebug) << "GlyphAtlasManager::evictPage(): Evicting page with texture ID "
+                  << page->textureId << " last used " << mFrameCount - page->lastUsedFrame
+                  << " frames ago";
+#endif
+    page->clear();
+    ++mPageEvictions;
+}
@@ -0,0 +1,108 @@
+//  SPDX-License-Identifier: MIT
+//
+//  ES-DE Frontend
+//  GlyphAtlasManager.h
+//
+//  Glyph atlas textures shared by all Font objects.
+//  When the memory cap has been reached the least recently used atlas page is cleared
+//  and reused, and any glyphs and text caches referring to it are recreated on demand.
+//
+
+#ifndef ES_CORE_RESOURCES_GLYPH_ATLAS_MANAGER_H
+#define ES_CORE_RESOURCES_GLYPH_ATLAS_MANAGER_H
+
+#include "utils/MathUtil.h"
+
+#include <memory>
+#include <vector>
+
+class GlyphAtlasManager
+{
+public:
+    class AtlasPage
+    {
+    public:
+        AtlasPage(const glm::ivec2& size);
+        ~AtlasPage();
+
+        // Finds room for a glyph using shelf packing. Glyphs are placed on the shelf with the
+        // tightest fit, and a new shelf is added at the bottom of the page if none fits.
+        bool findEmpty(const glm::ivec2& size, glm::ivec2& cursorOut);
+
+        // Removes all glyphs, which invalidates all references to the current generation.
+        void clear();
+
+        // You must call initTexture() after creating an AtlasPage to get a textureId.
+        void initTexture();
+        void deinitTexture();
+
+        unsigned int textureId;
+        glm::ivec2 textureSize;
+        // Increased each time the page is cleared, glyphs and text caches are only valid if
+        // they refer to the current generation.
+        unsigned int generation;
+        unsigned int lastUsedFrame;
+        size_t usedArea;
+        // Inactive pages have been released to stay within the memory cap, but the objects are
+        // kept around so that glyph and text cache references never point to deleted memory.
+        bool active;
+
+    private:
+        struct Shelf {
+            int posY;
+            int height;
+            int writePosX;
+        };
+
+        std::vector<Shelf> mShelves;
+        int mNextShelfPosY;
+    };
+
+    struct Statistics {
+        size_t pageCount;
+        size_t memUsage;
+        float occupancy;
+        unsigned long glyphHits;
+        unsigned long glyphMisses;
+        unsigned long pageEvictions;
+    };
+
+    GlyphAtlasManager();
+
+    // Returns a page with room for the glyph, evicting the least recently used page if this
+    // is required to stay within the memory cap.
+    AtlasPage* getPageForGlyph(const glm::ivec2& glyphSize, glm::ivec2& cursorOut);
+
+    void touchPage(AtlasPage* page) { page->lastUsedFrame = mFrameCount; }
+    static bool isValid(const AtlasPage* page, const unsigned int generation)
+    {
+        return page != nullptr && page->active && page->generation == generation;
+    }
+
+    void registerHit() { ++mGlyphHits; }
+    void registerMiss() { ++mGlyphMisses; }
+
+    // Called once per frame, pages touched during the current frame are never evicted.
+    void nextFrame();
+
+    void reloadPages();
+    void unloadPages();
+    // Deletes all pages, only to be called when no Font objects exist any longer.
+    void deletePages() { mPages.clear(); }
+
+    // Returns the VRAM used by all active atlas pages.
+    size_t getMemUsage() const;
+    const Statistics getStatistics() const;
+
+private:
+    void evictPage(AtlasPage* page);
+
+    std::vector<std::unique_ptr<AtlasPage>> mPages;
+
+    unsigned int mFrameCount;
+    unsigned long mGlyphHits;
+    unsigned long mGlyphMisses;
+    unsigned long mPageEvictions;
+};
+
+#endif // ES_CORE_RESOURCES_GLYPH_ATLAS_MANAGER_H
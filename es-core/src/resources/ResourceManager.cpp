@@ -14,7 +14,20 @@
 #include "utils/PlatformUtil.h"
 #include "utils/StringUtil.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+
+#if defined(_WIN64)
+#include <Windows.h>
+#elif !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Files at least this large are memory-mapped instead of being read into a buffer.
+#define MEMORY_MAP_MIN_FILE_SIZE (256 * 1024)
 
 ResourceManager& ResourceManager::getInstance()
 {
@@ -92,7 +105,8 @@ std::string ResourceManager::getResourcePath(const std::string& path, bool termi
     return path;
 }
 
-const ResourceData ResourceManager::getFileData(const std::string& path) const
+const ResourceData ResourceManager::getFileData(const std::string& path,
+                                                const bool allowMapping) const
 {
     // Check if its a resource.
     const std::string respath {getResourcePath(path)};
@@ -106,10 +120,9 @@ const ResourceData ResourceManager::getFileData(const std::string& path) const
         return data;
     }
 #else
-    if (Utils::FileSystem::exists(respath)) {
-        ResourceData data {loadFile(respath)};
-        return data;
-    }
+    // There is no need to check whether the file exists first, as loadFile() returns an
+    // "empty" ResourceData if it can't be opened.
+    return loadFile(respath, allowMapping);
 #endif
 
     // If the file doesn't exist, return an "empty" ResourceData.
@@ -117,27 +130,104 @@ const ResourceData ResourceManager::getFileData(const std::string& path) const
     return data;
 }
 
-ResourceData ResourceManager::loadFile(const std::string& path) const
+#if !defined(__ANDROID__)
+ResourceData ResourceManager::loadFile(const std::string& path, const bool allowMapping) const
 {
+    // If allowed, large files are memory-mapped so the decoders read the file contents directly
+    // from the page cache. The mappings are copy-on-write so the data can still be modified,
+    // and the ResourceData shared pointer unmaps the file when it's released.
 #if defined(_WIN64)
-    std::ifstream stream {Utils::String::stringToWideString(path).c_str(), std::ios::binary};
+    HANDLE file {CreateFileW(Utils::String::stringToWideString(path).c_str(), GENERIC_READ,
+                             FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                             nullptr)};
+    if (file == INVALID_HANDLE_VALUE)
+        return ResourceData {nullptr, 0};
+
+    LARGE_INTEGER fileSize {};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return ResourceData {nullptr, 0};
+    }
+
+    const size_t size {static_cast<size_t>(fileSize.QuadPart)};
+
+    if (allowMapping && size >= MEMORY_MAP_MIN_FILE_SIZE) {
+        HANDLE mapping {CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr)};
+        if (mapping != nullptr) {
+            void* view {MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0)};
+            // The view keeps a reference to the mapping object.
+            CloseHandle(mapping);
+            if (view != nullptr) {
+                CloseHandle(file);
+                std::shared_ptr<unsigned char> data {static_cast<unsigned char*>(view),
+                                                     [](unsigned char* p) { UnmapViewOfFile(p); }};
+                return ResourceData {data, size};
+            }
+        }
+    }
+
+    // Supply custom deleter to properly free array.
+    std::shared_ptr<unsigned char> data {new unsigned char[size],
+                                         [](unsigned char* p) { delete[] p; }};
+    size_t totalRead {0};
+    while (totalRead < size) {
+        DWORD bytesRead {0};
+        // ReadFile() can't read more than 4 GiB in a single call.
+        const DWORD chunkSize {
+            static_cast<DWORD>(size - totalRead > 0x40000000 ? 0x40000000 : size - totalRead)};
+        if (!ReadFile(file, data.get() + totalRead, chunkSize, &bytesRead, nullptr) ||
+            bytesRead == 0)
+            break;
+        totalRead += bytesRead;
+    }
+    CloseHandle(file);
 #else
-    std::ifstream stream {path, std::ios::binary};
-#endif
+    const int file {open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (file == -1)
+        return ResourceData {nullptr, 0};
 
-    stream.seekg(0, stream.end);
-    const size_t size {static_cast<size_t>(stream.tellg())};
-    stream.seekg(0, stream.beg);
+    struct stat fileInfo {};
+    if (fstat(file, &fileInfo) != 0 || !S_ISREG(fileInfo.st_mode)) {
+        close(file);
+        return ResourceData {nullptr, 0};
+    }
+
+    const size_t size {static_cast<size_t>(fileInfo.st_size)};
+
+    if (allowMapping && size >= MEMORY_MAP_MIN_FILE_SIZE) {
+        void* mapping {mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0)};
+        if (mapping != MAP_FAILED) {
+            close(file);
+            std::shared_ptr<unsigned char> data {static_cast<unsigned char*>(mapping),
+                                                 [size](unsigned char* p) { munmap(p, size); }};
+            return ResourceData {data, size};
+        }
+    }
 
     // Supply custom deleter to properly free array.
     std::shared_ptr<unsigned char> data {new unsigned char[size],
                                          [](unsigned char* p) { delete[] p; }};
-    stream.read(reinterpret_cast<char*>(data.get()), size);
-    stream.close();
+    size_t totalRead {0};
+    while (totalRead < size) {
+        const ssize_t bytesRead {read(file, data.get() + totalRead, size - totalRead)};
+        if (bytesRead == -1 && errno == EINTR)
+            continue;
+        if (bytesRead <= 0)
+            break;
+        totalRead += static_cast<size_t>(bytesRead);
+    }
+    close(file);
+#endif
+
+    if (totalRead != size) {
+        LOG(LogError) << "ResourceManager::loadFile(): Couldn't read file \"" << path << "\"";
+        return ResourceData {nullptr, 0};
+    }
 
     ResourceData ret {data, size};
     return ret;
 }
+#endif
 
 ResourceData ResourceManager::loadFile(SDL_RWops* resFile) const
 {
@@ -189,5 +279,17 @@ void ResourceManager::reloadAll()
 
 void ResourceManager::addReloadable(std::weak_ptr<IReloadable> reloadable)
 {
+    if (mReloadables.size() >= mPruneThreshold)
+        pruneReloadables();
+
     mReloadables.push_back(reloadable);
 }
+
+void ResourceManager::pruneReloadables()
+{
+    mReloadables.remove_if([](const std::weak_ptr<IReloadable>& reloadable) {
+        return reloadable.expired();
+    });
+
+    mPruneThreshold = std::max(MIN_PRUNE_THRESHOLD, mReloadables.size() * 2);
+}
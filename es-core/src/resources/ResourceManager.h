@@ -39,22 +39,41 @@ class ResourceManager
 public:
     static ResourceManager& getInstance();
 
+    // Expired entries are pruned whenever the number of registered reloadables has doubled
+    // since the last pruning, so the list stays proportional to the number of live resources.
     void addReloadable(std::weak_ptr<IReloadable> reloadable);
+    // Number of registered reloadables, including expired entries not yet pruned.
+    size_t getReloadableCount() const { return mReloadables.size(); }
 
     void unloadAll();
     void reloadAll();
 
     std::string getResourcePath(const std::string& path, bool terminateOnFailure = true) const;
-    const ResourceData getFileData(const std::string& path) const;
+    // If allowMapping is set, large files may be memory-mapped rather than read into a buffer.
+    // This must only be used if the data is released right after decoding it, as a file that
+    // is modified while mapped could crash the application, and on Windows the file can't be
+    // replaced or deleted while it's mapped.
+    const ResourceData getFileData(const std::string& path, const bool allowMapping = false) const;
     bool fileExists(const std::string& path) const;
 
 private:
-    ResourceManager() noexcept {}
+    ResourceManager() noexcept
+        : mPruneThreshold {MIN_PRUNE_THRESHOLD}
+    {
+    }
 
-    ResourceData loadFile(const std::string& path) const;
+    void pruneReloadables();
+
+#if !defined(__ANDROID__)
+    // Returns an "empty" ResourceData if the file can't be opened.
+    ResourceData loadFile(const std::string& path, const bool allowMapping) const;
+#endif
     ResourceData loadFile(SDL_RWops* resFile) const;
 
+    static constexpr size_t MIN_PRUNE_THRESHOLD {512};
+
     std::list<std::weak_ptr<IReloadable>> mReloadables;
+    size_t mPruneThreshold;
 };
 
 #endif // ES_CORE_RESOURCES_RESOURCE_MANAGER_H
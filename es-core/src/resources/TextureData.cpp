@@ -15,8 +15,23 @@
 
 #include "lunasvg.h"
 
+#include <algorithm>
 #include <string.h>
 
+// Maximum size in MiB of resized SVG images to upload to VRAM per frame, any remaining images
+// keep using their previous texture and are uploaded during the following frames. The first
+// texture uploaded during a frame is not restricted by this value.
+#define TEXTURE_UPLOAD_BUDGET 8
+
+// Maximum size in MiB of the rasterized SVG images kept in RAM for reuse, in addition to
+// the images held by the textures themselves.
+#define SVG_RASTER_CACHE_SIZE 32
+// SVG images are rasterized at sizes rounded up to the nearest bucket, where the buckets are
+// spaced at 1/SVG_SIZE_BUCKETS of the nearest lower power of two. Smaller sizes than
+// SVG_MIN_BUCKET_SIZE are used as-is.
+#define SVG_SIZE_BUCKETS 8
+#define SVG_MIN_BUCKET_SIZE 32
+
 TextureData::TextureData(bool tile)
     : mRenderer {Renderer::getInstance()}
     , mTile {tile}
@@ -32,6 +47,9 @@ TextureData::TextureData(bool tile)
     , mPendingRasterization {false}
     , mMipmapping {false}
     , mInvalidSVGFile {false}
+    , mPendingResize {false}
+    , mPendingStreamUpload {false}
+    , mPendingRecreate {false}
     , mLinearMagnify {false}
 {
 }
@@ -50,20 +68,25 @@ void TextureData::initFromPath(const std::string& path)
     mReloadable = true;
 }
 
-bool TextureData::initSVGFromMemory(const std::string& fileData)
+bool TextureData::initSVGFromMemory(const char* fileData, size_t length)
 {
     std::unique_lock<std::mutex> lock {mMutex};
 
     // If already initialized then don't process it again unless it needs to be rasterized.
-    if (!mDataRGBA.empty() && !mPendingRasterization)
+    if (!mDataRGBA.empty() && !mPendingRasterization && !mPendingResize)
         return true;
 
-    auto svgImage = lunasvg::Document::loadFromData(fileData);
+    // The lock is not held while parsing and rasterizing the image so that the render thread
+    // can keep using the previous texture in the meantime.
+    lock.unlock();
+    auto svgImage = lunasvg::Document::loadFromData(fileData, length);
+    lock.lock();
 
     if (svgImage == nullptr) {
         LOG(LogError) << "TextureData::initSVGFromMemory(): Couldn't parse SVG image \"" << mPath
                       << "\"";
         mInvalidSVGFile = true;
+        mPendingResize = false;
         return false;
     }
 
@@ -91,33 +114,63 @@ bool TextureData::initSVGFromMemory(const std::string& fileData)
         mSourceHeight = 64.0f * (svgHeight / svgWidth);
     }
 
-    mWidth = static_cast<int>(std::round(mSourceWidth));
-    mHeight = static_cast<int>(std::round(mSourceHeight));
+    const float sourceWidth {mSourceWidth};
+    const float sourceHeight {mSourceHeight};
 
-    if (mWidth == 0) {
+    // Tiled images need to be rasterized at their exact size, all other images are stretched
+    // to the size of the component so these are rasterized at the nearest larger size bucket.
+    int width {mTile ? static_cast<int>(std::round(sourceWidth)) : getSizeBucket(sourceWidth)};
+    int height {mTile ? static_cast<int>(std::round(sourceHeight)) :
+                        getSizeBucket(sourceHeight)};
+
+    if (width == 0) {
         // Auto scale width to keep aspect ratio.
-        mWidth =
-            static_cast<size_t>(std::round((static_cast<float>(mHeight) / svgHeight) * svgWidth));
+        width = static_cast<int>(std::round((static_cast<float>(height) / svgHeight) * svgWidth));
     }
-    else if (mHeight == 0) {
+    else if (height == 0) {
         // Auto scale height to keep aspect ratio.
-        mHeight =
-            static_cast<size_t>(std::round((static_cast<float>(mWidth) / svgWidth) * svgHeight));
+        height = static_cast<int>(std::round((static_cast<float>(width) / svgWidth) * svgHeight));
     }
 
     if (rasterize) {
-        auto bitmap = svgImage->renderToBitmap(mWidth, mHeight);
-        mDataRGBA.insert(mDataRGBA.begin(), std::move(bitmap.data()),
-                         std::move(bitmap.data() + mWidth * mHeight * 4));
+        lock.unlock();
+        std::shared_ptr<const std::vector<unsigned char>> pixels {
+            getCachedRaster(mPath, width, height)};
+
+        if (pixels == nullptr) {
+            auto bitmap = svgImage->renderToBitmap(width, height);
+            std::shared_ptr<std::vector<unsigned char>> rasterized {
+                std::make_shared<std::vector<unsigned char>>(
+                    bitmap.data(), bitmap.data() + width * height * 4)};
+            ImageIO::flipPixelsVert(rasterized->data(), width, height);
+            pixels = rasterized;
+            cacheRaster(mPath, width, height, pixels);
+        }
+        lock.lock();
 
-        ImageIO::flipPixelsVert(mDataRGBA.data(), mWidth, mHeight);
+        // The size may have been changed again while rasterizing, in which case the image
+        // will be rasterized once more when the texture is loaded the next time.
+        if (!mTile && (getSizeBucket(mSourceWidth) != getSizeBucket(sourceWidth) ||
+                       getSizeBucket(mSourceHeight) != getSizeBucket(sourceHeight)))
+            return true;
+
+        mDataRGBA.assign(pixels->cbegin(), pixels->cend());
+        mWidth = width;
+        mHeight = height;
         mPendingRasterization = false;
         mHasRGBAData = true;
+        // The previous texture is replaced on the next bind.
+        if (mPendingResize && mTextureID != 0)
+            mPendingRecreate = true;
+        mPendingResize = false;
     }
     else {
+        mWidth = width;
+        mHeight = height;
         // TODO: Fix this properly instead of using the single byte texture workaround.
         mDataRGBA.push_back(0);
         mPendingRasterization = true;
+        mPendingResize = false;
     }
 
     return true;
@@ -171,6 +224,22 @@ bool TextureData::initFromRGBA(const unsigned char* dataRGBA, size_t width, size
     return true;
 }
 
+bool TextureData::updateFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+    // Mipmaps would need to be regenerated so in this case just recreate the texture.
+    if (mTextureID == 0 || mMipmapping || static_cast<int>(width) != mWidth ||
+        static_cast<int>(height) != mHeight)
+        return false;
+
+    // The existing allocation is reused, which is important for video frames.
+    mDataRGBA.assign(dataRGBA, dataRGBA + (width * height * 4));
+    mHasRGBAData = true;
+    mPendingStreamUpload = true;
+
+    return true;
+}
+
 bool TextureData::load()
 {
     if (mInvalidSVGFile)
@@ -180,13 +249,11 @@ bool TextureData::load()
 
     // Need to load. See if there is a file.
     if (!mPath.empty()) {
-        const ResourceData& data = ResourceManager::getInstance().getFileData(mPath);
+        const ResourceData& data = ResourceManager::getInstance().getFileData(mPath, true);
         // Is it an SVG?
         if (Utils::String::toLower(mPath.substr(mPath.size() - 4, std::string::npos)) == ".svg") {
             mScalable = true;
-            std::string dataString;
-            dataString.assign(std::string(reinterpret_cast<char*>(data.ptr.get()), data.length));
-            retval = initSVGFromMemory(dataString);
+            retval = initSVGFromMemory(reinterpret_cast<const char*>(data.ptr.get()), data.length);
         }
         else {
             retval =
@@ -199,6 +266,8 @@ bool TextureData::load()
 bool TextureData::isLoaded()
 {
     std::unique_lock<std::mutex> lock {mMutex};
+    if (mPendingResize)
+        return false;
     if (!mDataRGBA.empty() || mTextureID != 0)
         if (mHasRGBAData || mPendingRasterization || mTextureID != 0)
             return true;
@@ -206,11 +275,31 @@ bool TextureData::isLoaded()
     return false;
 }
 
-bool TextureData::uploadAndBind(const unsigned int texUnit)
+bool TextureData::uploadAndBind(const unsigned int texUnit, const bool deferUpload)
 {
     // Check if it has already been uploaded.
     std::unique_lock<std::mutex> lock {mMutex};
+
+    if (mTextureID != 0 && mPendingRecreate) {
+        // An SVG image has been rasterized at a new size. If the upload is deferred then the
+        // previous texture is used for another frame.
+        const size_t uploadBytes {static_cast<size_t>(mWidth * mHeight * 4)};
+        if (!deferUpload || sFrameUploadBytes == 0 ||
+            sFrameUploadBytes + uploadBytes <=
+                static_cast<size_t>(TEXTURE_UPLOAD_BUDGET) * 1024 * 1024) {
+            mRenderer->destroyTexture(mTextureID);
+            mTextureID = 0;
+            mPendingRecreate = false;
+        }
+    }
+
     if (mTextureID != 0) {
+        if (mPendingStreamUpload && !mDataRGBA.empty()) {
+            mRenderer->streamTexture(mTextureID, texUnit, Renderer::TextureType::BGRA,
+                                     static_cast<const unsigned int>(mWidth),
+                                     static_cast<const unsigned int>(mHeight), mDataRGBA.data());
+        }
+        mPendingStreamUpload = false;
         mRenderer->bindTexture(mTextureID, texUnit);
     }
     else {
@@ -218,6 +307,10 @@ bool TextureData::uploadAndBind(const unsigned int texUnit)
         if (mWidth == 0 || mHeight == 0 || mDataRGBA.empty())
             return false;
 
+        // There is no previous texture that could be shown instead, so this is never deferred
+        // as a blank texture could otherwise end up in cached render output.
+        sFrameUploadBytes += static_cast<size_t>(mWidth * mHeight * 4);
+
         // Upload texture.
         mTextureID =
             mRenderer->createTexture(texUnit, Renderer::TextureType::BGRA, true, mLinearMagnify,
@@ -234,6 +327,8 @@ void TextureData::releaseVRAM()
         mRenderer->destroyTexture(mTextureID);
         mTextureID = 0;
     }
+    mPendingStreamUpload = false;
+    mPendingRecreate = false;
 }
 
 void TextureData::releaseRAM()
@@ -285,14 +380,86 @@ void TextureData::setSourceSize(float width, float height)
         // Ugly hack to make sure SVG images matching the temporary size 64x64 get rasterized.
         const bool tempSizeMatch {mPendingRasterization && width == 64 && height == 64};
         if (tempSizeMatch || mSourceWidth != width || mSourceHeight != height) {
+            // Non-tiled images only need to be rasterized again if the size bucket changes.
+            const bool sameBucket {!mTile && !tempSizeMatch && !mPendingRasterization &&
+                                   getSizeBucket(mSourceWidth) == getSizeBucket(width) &&
+                                   getSizeBucket(mSourceHeight) == getSizeBucket(height)};
             mSourceWidth = width;
             mSourceHeight = height;
-            releaseVRAM();
-            releaseRAM();
+            if (sameBucket)
+                return;
+            if (!mTile && !mPendingRasterization && mTextureID != 0) {
+                // Keep the current texture until the image has been rasterized at the new size,
+                // which is done by the texture loader unless the texture is force loaded.
+                mPendingResize = true;
+                releaseRAM();
+            }
+            else {
+                releaseVRAM();
+                releaseRAM();
+            }
         }
     }
 }
 
+void TextureData::clearRasterCache()
+{
+    std::unique_lock<std::mutex> lock {sRasterCacheMutex};
+    sRasterCache.clear();
+    sRasterCacheLookup.clear();
+    sRasterCacheSize = 0;
+}
+
+int TextureData::getSizeBucket(const float size)
+{
+    const int roundedSize {static_cast<int>(std::ceil(size))};
+    if (roundedSize <= SVG_MIN_BUCKET_SIZE)
+        return roundedSize;
+
+    const int step {std::max(1, (1 << static_cast<int>(std::floor(std::log2(size)))) /
+                                    SVG_SIZE_BUCKETS)};
+    return ((roundedSize + step - 1) / step) * step;
+}
+
+std::shared_ptr<const std::vector<unsigned char>> TextureData::getCachedRaster(
+    const std::string& path, const int width, const int height)
+{
+    std::unique_lock<std::mutex> lock {sRasterCacheMutex};
+    auto it = sRasterCacheLookup.find(RasterCacheKeyType {path, width, height});
+    if (it == sRasterCacheLookup.cend())
+        return nullptr;
+
+    // Move the entry to the front of the list.
+    sRasterCache.splice(sRasterCache.begin(), sRasterCache, it->second);
+    return it->second->pixels;
+}
+
+void TextureData::cacheRaster(const std::string& path,
+                              const int width,
+                              const int height,
+                              const std::shared_ptr<const std::vector<unsigned char>>& pixels)
+{
+    const size_t maxSize {static_cast<size_t>(SVG_RASTER_CACHE_SIZE) * 1024 * 1024};
+    if (path.empty() || pixels->size() > maxSize / 4)
+        return;
+
+    std::unique_lock<std::mutex> lock {sRasterCacheMutex};
+    const RasterCacheKeyType key {path, width, height};
+    if (sRasterCacheLookup.find(key) != sRasterCacheLookup.cend())
+        return;
+
+    sRasterCache.push_front(RasterCacheEntry {key, pixels});
+    sRasterCacheLookup[key] = sRasterCache.begin();
+    sRasterCacheSize += pixels->size();
+
+    // Evict the least recently used images.
+    while (sRasterCacheSize > maxSize) {
+        sRasterCacheSize -= sRasterCache.back().pixels->size();
+        sRasterCacheLookup.erase(sRasterCache.back().key);
+        sRasterCache.pop_back();
+    }
+}
+
 size_t TextureData::getVRAMUsage()
 {
     if (mHasRGBAData || mTextureID != 0) {
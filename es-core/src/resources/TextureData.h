@@ -14,8 +14,12 @@
 
 #include <atomic>
 #include <cmath>
+#include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <tuple>
 #include <vector>
 
 class TextureResource;
@@ -30,9 +34,13 @@ public:
 
     // Needs to be canonical path. Caller should check for duplicates before calling this.
     void initFromPath(const std::string& path);
-    bool initSVGFromMemory(const std::string& fileData);
+    bool initSVGFromMemory(const char* fileData, size_t length);
     bool initImageFromMemory(const unsigned char* fileData, size_t length);
     bool initFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
+    // Replaces the pixel data of a texture that has already been uploaded, the new data will be
+    // streamed to the existing texture on the next bind. Returns false if the texture needs to
+    // be recreated instead, which is the case if the dimensions have changed.
+    bool updateFromRGBA(const unsigned char* dataRGBA, size_t width, size_t height);
 
     // Read the data into memory if necessary.
     bool load();
@@ -40,8 +48,14 @@ public:
     bool isLoaded();
 
     // Upload the texture to VRAM if necessary and bind.
-    // Returns true if bound correctly.
-    bool uploadAndBind(const unsigned int texUnit);
+    // Returns true if bound correctly. If deferUpload is set, the upload of a resized SVG image
+    // may be postponed to a later frame in case the per-frame upload budget has been exhausted,
+    // in which case the previous texture is bound. Textures without a previous texture are
+    // always uploaded right away.
+    bool uploadAndBind(const unsigned int texUnit, const bool deferUpload = false);
+
+    // Resets the per-frame upload budget.
+    static void nextFrame() { sFrameUploadBytes = 0; }
 
     // Release the texture from VRAM.
     void releaseVRAM();
@@ -71,6 +85,12 @@ public:
 
     // Has the image been loaded but not yet been rasterized as the size was not known?
     const bool getPendingRasterization() { return mPendingRasterization; }
+    // Is the SVG image waiting to be rasterized at a new size? The texture for the previous
+    // size is still used until the rasterization has completed.
+    const bool getPendingResize() { return mPendingResize; }
+
+    // Clears the rasterized SVG images, needed if the SVG files may have been modified.
+    static void clearRasterCache();
 
     const bool getScalable() { return mScalable; }
     const std::vector<unsigned char>& getRawRGBAData() { return mDataRGBA; }
@@ -79,6 +99,17 @@ public:
     const bool getIsInvalidSVGFile() { return mInvalidSVGFile; }
 
 private:
+    // Rounds up an SVG rasterization size to the nearest size bucket.
+    static int getSizeBucket(const float size);
+
+    // Returns nullptr if the image is not in the cache.
+    static std::shared_ptr<const std::vector<unsigned char>> getCachedRaster(
+        const std::string& path, const int width, const int height);
+    static void cacheRaster(const std::string& path,
+                            const int width,
+                            const int height,
+                            const std::shared_ptr<const std::vector<unsigned char>>& pixels);
+
     Renderer* mRenderer;
     std::mutex mMutex;
 
@@ -97,8 +128,27 @@ private:
     std::atomic<bool> mPendingRasterization;
     std::atomic<bool> mMipmapping;
     std::atomic<bool> mInvalidSVGFile;
+    std::atomic<bool> mPendingResize;
+    bool mPendingStreamUpload;
+    bool mPendingRecreate;
     bool mLinearMagnify;
     bool mReloadable;
+
+    static inline size_t sFrameUploadBytes {0};
+
+    // File path, width, height.
+    using RasterCacheKeyType = std::tuple<std::string, int, int>;
+    struct RasterCacheEntry {
+        RasterCacheKeyType key;
+        std::shared_ptr<const std::vector<unsigned char>> pixels;
+    };
+
+    // Rasterized SVG images with the most recently used entry first.
+    static inline std::list<RasterCacheEntry> sRasterCache;
+    static inline std::map<RasterCacheKeyType, std::list<RasterCacheEntry>::iterator>
+        sRasterCacheLookup;
+    static inline size_t sRasterCacheSize {0};
+    static inline std::mutex sRasterCacheMutex;
 };
 
 #endif // ES_CORE_RESOURCES_TEXTURE_DATA_H
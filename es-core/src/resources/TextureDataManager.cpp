@@ -71,7 +71,7 @@ bool TextureDataManager::bind(const TextureResource* key, const unsigned int tex
     std::shared_ptr<TextureData> tex {get(key)};
     bool bound {false};
     if (tex != nullptr)
-        bound = tex->uploadAndBind(texUnit);
+        bound = tex->uploadAndBind(texUnit, true);
     if (!bound)
         mBlank->uploadAndBind(texUnit);
     return bound;
@@ -99,6 +99,12 @@ size_t TextureDataManager::getQueueSize()
     return mLoader->getQueueSize();
 }
 
+size_t TextureDataManager::getQueueCount()
+{
+    // Return the number of queued textures.
+    return mLoader->getQueueCount();
+}
+
 void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 {
     // See if it's already loaded.
@@ -233,3 +239,9 @@ size_t TextureLoader::getQueueSize()
 
     return mem;
 }
+
+size_t TextureLoader::getQueueCount()
+{
+    std::unique_lock<std::mutex> lock {mMutex};
+    return mTextureDataQ.size();
+}
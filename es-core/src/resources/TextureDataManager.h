@@ -31,6 +31,7 @@ public:
 
     void setExit() { mExit = true; }
     size_t getQueueSize();
+    size_t getQueueCount();
 
 private:
     void processQueue();
@@ -82,6 +83,8 @@ public:
     // Get the total size of all load-pending textures in the queue - these will
     // be committed to VRAM as the queue is processed.
     size_t getQueueSize();
+    // Get the number of textures in the queue.
+    size_t getQueueCount();
     // Load a texture, freeing resources as necessary to make space.
     void load(std::shared_ptr<TextureData> tex, bool block = false);
     // Make sure that threadProc() does not continue to run during application shutdown.
@@ -8,12 +8,19 @@
 
 #include "resources/TextureResource.h"
 
+#include "Settings.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 
+#include <algorithm>
+
 #define DEBUG_RASTER_CACHING false
 #define DEBUG_SVG_CACHING false
 
+// Textures are only preloaded while the total texture memory usage is below this percentage
+// of the MaxVRAM setting.
+#define PRELOAD_MAX_VRAM_PERCENTAGE 75
+
 TextureResource::TextureResource(const std::string& path,
                                  float tileWidth,
                                  float tileHeight,
@@ -81,9 +88,13 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 {
     // This is only valid if we have a local texture data object.
     assert(mTextureData != nullptr);
-    mTextureData->releaseVRAM();
-    mTextureData->releaseRAM();
-    mTextureData->initFromRGBA(dataRGBA, width, height);
+    // Textures that are updated with new pixel data of the same size, such as video frames,
+    // are streamed to the existing texture instead of getting recreated.
+    if (!mTextureData->updateFromRGBA(dataRGBA, width, height)) {
+        mTextureData->releaseVRAM();
+        mTextureData->releaseRAM();
+        mTextureData->initFromRGBA(dataRGBA, width, height);
+    }
     // Cache the image dimensions.
     mSize = glm::ivec2 {static_cast<int>(width), static_cast<int>(height)};
     mSourceSize = glm::vec2 {static_cast<float>(width), static_cast<float>(height)};
@@ -104,7 +115,7 @@ void TextureResource::initFromMemory(const char* data, size_t length)
 
 void TextureResource::manualUnload(const std::string& path, bool tile)
 {
-    const std::string canonicalPath {Utils::FileSystem::getCanonicalPath(path)};
+    const std::string canonicalPath {Utils::FileSystem::getCachedCanonicalPath(path)};
 
     // TODO: We always attempt to unload both the linear and nearest interpolation entries.
     // Rewrite this to only unload the requested image.
@@ -118,6 +129,14 @@ void TextureResource::manualUnload(const std::string& path, bool tile)
     }
 }
 
+bool TextureResource::hasPreloadHeadroom()
+{
+    const size_t maxMemUsage {
+        static_cast<size_t>(std::clamp(Settings::getInstance()->getInt("MaxVRAM"), 128, 2048)) *
+        1024 * 1024};
+    return getTotalMemUsage() < maxMemUsage / 100 * PRELOAD_MAX_VRAM_PERCENTAGE;
+}
+
 std::vector<unsigned char> TextureResource::getRawRGBAData()
 {
     std::shared_ptr<TextureData> data {sTextureDataManager.get(this)};
@@ -168,7 +187,7 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path,
                                                       float tileWidth,
                                                       float tileHeight)
 {
-    const std::string canonicalPath {Utils::FileSystem::getCanonicalPath(path)};
+    const std::string canonicalPath {Utils::FileSystem::getCachedCanonicalPath(path)};
     if (canonicalPath.empty()) {
         std::shared_ptr<TextureResource> tex(new TextureResource(
             "", tileWidth, tileHeight, tile, false, linearMagnify, mipmapping, false));
@@ -259,7 +278,9 @@ void TextureResource::rasterizeAt(float width, float height)
     if (mTextureData && mTextureData.get()->getScalable())
         mSourceSize = glm::vec2 {static_cast<float>(width), static_cast<float>(height)};
     data->setSourceSize(static_cast<float>(width), static_cast<float>(height));
-    if (mForceLoad || mTextureData != nullptr)
+    // If the SVG image is resized, the previous texture is used until the texture loader has
+    // rasterized it at the new size.
+    if ((mForceLoad && !data->getPendingResize()) || mTextureData != nullptr)
         data->load();
 }
 
@@ -17,6 +17,7 @@
 #include <cmath>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class TextureData;
@@ -40,6 +41,9 @@ public:
     virtual void initFromMemory(const char* data, size_t length);
     static void manualUnload(const std::string& path, bool tile);
     static void manualUnloadAll() { sTextureMap.clear(); }
+    // Whether there is enough free texture memory to load textures ahead of them being
+    // displayed, without that leading to textures currently in use getting evicted.
+    static bool hasPreloadHeadroom();
 
     // Returns the raw pixel values.
     std::vector<unsigned char> getRawRGBAData();
@@ -79,8 +83,12 @@ public:
     static size_t getTotalMemUsage();
     // Returns the number of bytes that would be used if all textures were in memory.
     static size_t getTotalTextureSize();
+    // Number of textures waiting to be loaded by the texture loader thread.
+    static size_t getLoaderQueueSize() { return sTextureDataManager.getQueueCount(); }
 
     static void setExit() { sTextureDataManager.setExit(); }
+    // Called once per frame to reset the texture upload budget.
+    static void nextFrame() { TextureData::nextFrame(); }
 
 protected:
     TextureResource(const std::string& path,
@@ -109,8 +117,23 @@ private:
 
     // File path, tile, linear interpolation, mipmapping, scalable/SVG, width, height.
     using TextureKeyType = std::tuple<std::string, bool, bool, bool, bool, size_t, size_t>;
+    struct TextureKeyHash {
+        size_t operator()(const TextureKeyType& key) const
+        {
+            size_t hash {std::hash<std::string> {}(std::get<0>(key))};
+            const size_t flags {static_cast<size_t>(std::get<1>(key)) |
+                                static_cast<size_t>(std::get<2>(key)) << 1 |
+                                static_cast<size_t>(std::get<3>(key)) << 2 |
+                                static_cast<size_t>(std::get<4>(key)) << 3};
+            // Combine the hashes in the same way as boost::hash_combine().
+            for (const size_t value : {flags, std::get<5>(key), std::get<6>(key)})
+                hash ^= std::hash<size_t> {}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
     // Map of textures, used to prevent duplicate textures.
-    static inline std::map<TextureKeyType, std::weak_ptr<TextureResource>> sTextureMap;
+    static inline std::unordered_map<TextureKeyType, std::weak_ptr<TextureResource>, TextureKeyHash>
+        sTextureMap;
     // Set of all textures, used for memory management.
     static inline std::set<TextureResource*> sAllTextures;
 };
@@ -24,8 +24,11 @@
 #include "utils/StringUtil.h"
 
 #include <fstream>
+#include <mutex>
 #include <regex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <sys/stat.h>
 
 #if defined(_WIN64)
@@ -36,6 +39,9 @@
 #include <unistd.h>
 #endif
 
+// Maximum number of entries in the canonical path cache, it's cleared if this is exceeded.
+#define MAX_CANONICAL_PATH_CACHE_SIZE 16384
+
 // For Unix systems, set the install prefix as defined via CMAKE_INSTALL_PREFIX when CMake was run.
 // If not defined, the default prefix "/usr" will be used on Linux and "/usr/local" on FreeBSD.
 // This fallback should not be required though unless the build environment is broken.
@@ -59,6 +65,9 @@ namespace Utils
         static std::string exePath;
         static std::string esBinary;
 
+        static std::unordered_map<std::string, std::string> canonicalPathCache;
+        static std::shared_mutex canonicalPathCacheMutex;
+
         StringList getDirContent(const std::string& path, const bool recursive)
         {
             const std::string& genericPath {getGenericPath(path)};
@@ -571,6 +580,36 @@ namespace Utils
             return canonicalPath;
         }
 
+        std::string getCachedCanonicalPath(const std::string& path)
+        {
+            // Relative paths depend on the current working directory so these are not cached.
+            // For absolute paths the result only changes if a symlink in the path is modified.
+            if (path.empty() || (path[0] == ':' && path[1] == '/') || !isAbsolute(path))
+                return getCanonicalPath(path);
+
+            {
+                std::shared_lock<std::shared_mutex> lock {canonicalPathCacheMutex};
+                auto it = canonicalPathCache.find(path);
+                if (it != canonicalPathCache.cend())
+                    return it->second;
+            }
+
+            const std::string canonicalPath {getCanonicalPath(path)};
+
+            std::unique_lock<std::shared_mutex> lock {canonicalPathCacheMutex};
+            if (canonicalPathCache.size() >= MAX_CANONICAL_PATH_CACHE_SIZE)
+                canonicalPathCache.clear();
+            canonicalPathCache.emplace(path, canonicalPath);
+
+            return canonicalPath;
+        }
+
+        void clearCanonicalPathCache()
+        {
+            std::unique_lock<std::shared_mutex> lock {canonicalPathCacheMutex};
+            canonicalPathCache.clear();
+        }
+
         std::string getAbsolutePath(const std::string& path, const std::string& base)
         {
             const std::string& absolutePath {getGenericPath(path)};
@@ -660,6 +699,28 @@ namespace Utils
             }
         }
 
+        long long getFileModificationTime(const std::filesystem::path& path)
+        {
+            // The value is only meaningful for comparisons against other values returned
+            // by this function, it's not necessarily relative to the Unix epoch.
+            try {
+#if defined(_WIN64)
+                return static_cast<long long>(
+                    std::filesystem::last_write_time(
+                        Utils::String::stringToWideString(path.generic_string()))
+                        .time_since_epoch()
+                        .count());
+#else
+                return static_cast<long long>(
+                    std::filesystem::last_write_time(path).time_since_epoch().count());
+#endif
+            }
+            catch (std::filesystem::filesystem_error& error) {
+                LOG(LogError) << "FileSystemUtil::getFileModificationTime(): " << error.what();
+                return -1;
+            }
+        }
+
         std::string expandHomePath(const std::string& path)
         {
             // Expand home path if ~ is used.
@@ -841,6 +902,8 @@ namespace Utils
                 return true;
             }
 
+            clearCanonicalPathCache();
+
 #if defined(_WIN64)
             return _wrename(Utils::String::stringToWideString(sourcePath).c_str(),
                             Utils::String::stringToWideString(destinationPath).c_str());
@@ -877,6 +940,7 @@ namespace Utils
         bool removeFile(const std::string& path)
         {
             const std::string& genericPath {getGenericPath(path)};
+            clearCanonicalPathCache();
             try {
 #if defined(_WIN64)
                 return std::filesystem::remove(Utils::String::stringToWideString(genericPath));
@@ -893,6 +957,7 @@ namespace Utils
         bool removeDirectory(const std::string& path, bool recursive)
         {
             const std::string& genericPath {getGenericPath(path)};
+            clearCanonicalPathCache();
             try {
 #if defined(_WIN64)
                 if (recursive)
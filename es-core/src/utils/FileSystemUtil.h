@@ -45,6 +45,12 @@ namespace Utils
         std::string getGenericPath(const std::string& path);
         std::string getEscapedPath(const std::string& path);
         std::string getCanonicalPath(const std::string& path);
+        // Memoized version of getCanonicalPath() for absolute paths, intended for the resource
+        // lookups which are performed repeatedly for the same paths.
+        std::string getCachedCanonicalPath(const std::string& path);
+        // Called automatically when files are renamed or removed, but needs to be called
+        // explicitly if symlinks are modified outside the application.
+        void clearCanonicalPathCache();
         std::string getAbsolutePath(const std::string& path,
                                     const std::string& base = getCWDPath());
         std::string getParent(const std::string& path);
@@ -52,6 +58,7 @@ namespace Utils
         std::string getStem(const std::string& path);
         std::string getExtension(const std::string& path);
         long getFileSize(const std::filesystem::path& path);
+        long long getFileModificationTime(const std::filesystem::path& path);
         std::string expandHomePath(const std::string& path);
         std::string resolveRelativePath(const std::string& path,
                                         const std::string& relativeTo,
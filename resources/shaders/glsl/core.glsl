@@ -49,6 +49,7 @@ uniform uint shaderFlags;
 
 uniform sampler2D textureSampler0;
 uniform sampler2D textureSampler1;
+uniform sampler2D textureSampler2;
 out vec4 FragColor;
 
 // shaderFlags:
@@ -60,6 +61,10 @@ out vec4 FragColor;
 // 0x00000020 - Rounded corners
 // 0x00000040 - Rounded corners with no anti-aliasing
 // 0x00000080 - Convert pixel format
+// 0x00000100 - Signed distance field font texture
+// 0x00000200 - YUV video frame (Y, U and V planes in texture units 0, 1 and 2)
+// 0x00000400 - YUV video frame using BT.709 colorspace (BT.601 otherwise)
+// 0x00000800 - YUV video frame using full range (limited range otherwise)
 
 void main()
 {
@@ -79,10 +84,33 @@ void main()
 
     // Pixel format conversion is sometimes required as not all mobile GPUs support all
     // OpenGL operations in BGRA format.
-    if (0x0u != (shaderFlags & 0x80u))
+    if (0x0u != (shaderFlags & 0x200u)) {
+        // Video frames uploaded as separate luma and chroma planes.
+        vec3 yuv = vec3(texture(textureSampler0, texCoord).r,
+                        texture(textureSampler1, texCoord).r,
+                        texture(textureSampler2, texCoord).r);
+        if (0x0u != (shaderFlags & 0x800u)) {
+            yuv.yz -= 0.5;
+        }
+        else {
+            yuv.x = (yuv.x - 16.0 / 255.0) * (255.0 / 219.0);
+            yuv.yz = (yuv.yz - 128.0 / 255.0) * (255.0 / 224.0);
+        }
+        vec3 rgb;
+        if (0x0u != (shaderFlags & 0x400u))
+            rgb = vec3(yuv.x + 1.5748 * yuv.z, yuv.x - 0.1873 * yuv.y - 0.4681 * yuv.z,
+                       yuv.x + 1.8556 * yuv.y);
+        else
+            rgb = vec3(yuv.x + 1.402 * yuv.z, yuv.x - 0.344136 * yuv.y - 0.714136 * yuv.z,
+                       yuv.x + 1.772 * yuv.y);
+        sampledColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+    }
+    else if (0x0u != (shaderFlags & 0x80u)) {
         sampledColor.bgra = texture(textureSampler0, texCoord);
-    else
+    }
+    else {
         sampledColor = texture(textureSampler0, texCoord);
+    }
 
     // Rounded corners.
     if (0x0u != (shaderFlags & 0x20u) || 0x0u != (shaderFlags & 0x40u)) {
@@ -131,9 +159,17 @@ void main()
         sampledColor = vec4(blendedColor, sampledColor.a);
     }
 
-    // For fonts the alpha information is stored in the red channel.
-    if (0x0u != (shaderFlags & 0x2u))
+    // For fonts the alpha information is stored in the red channel. For signed distance
+    // field fonts the red channel instead contains the distance to the glyph outline, with
+    // the edge located at 0.5.
+    if (0x0u != (shaderFlags & 0x100u)) {
+        float edgeWidth = max(fwidth(sampledColor.r) * 0.5, 0.0001);
+        sampledColor =
+            vec4(1.0, 1.0, 1.0, smoothstep(0.5 - edgeWidth, 0.5 + edgeWidth, sampledColor.r));
+    }
+    else if (0x0u != (shaderFlags & 0x2u)) {
         sampledColor = vec4(1.0, 1.0, 1.0, sampledColor.r);
+    }
 
     // We need different color calculations depending on whether the texture contains
     // premultiplied alpha or straight alpha values.
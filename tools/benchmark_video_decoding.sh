@@ -0,0 +1,123 @@
+#!/usr/bin/bash
+#  SPDX-License-Identifier: MIT
+#
+#  ES-DE
+#  benchmark_video_decoding.sh
+#
+#  Decodes a set of video files at several display sizes and reports the CPU time used per
+#  second of playback. This is intended for measuring the effect of decoding at display
+#  resolution rather than at source resolution.
+#
+#  The filter chain is built the same way as in VideoFFmpegComponent::setupVideoFilters(), and
+#  the decode size is calculated the same way as in calculateDecodeSize() for a video that is
+#  scaled to fit inside the display size. Any changes to these functions need to be reflected
+#  here. The remaining differences to the video player are that ffmpeg feeds the frames to the
+#  filter graph at their actual width, while the player declares the width padded to a multiple
+#  of 16 pixels for its buffer source. Also, only software decoding is measured and ffmpeg picks
+#  its own number of decoding and filtering threads.
+#
+#  The frames are converted to BGRA by default, set PIXEL_FORMAT=yuv420p to instead measure
+#  the VideoGPUColorConversion code path. Set UPSCALE_FRAME_RATE=false to skip the 60 FPS
+#  frame rate upscaling, corresponding to the VideoUpscaleFrameRate setting.
+#
+#  ffmpeg, ffprobe and bc must be installed or this script will fail.
+#
+#  This script is only intended to be used on Linux systems.
+#
+
+if [ $# -eq 0 ]; then
+  echo "Usage: ./benchmark_video_decoding.sh <video file> [<video file> ...]"
+  echo "For example:"
+  echo "./benchmark_video_decoding.sh ~/ES-DE/downloaded_media/snes/videos/*.mp4"
+  exit
+fi
+
+if ! command -v ffmpeg > /dev/null || ! command -v ffprobe > /dev/null ||
+  ! command -v bc > /dev/null; then
+  echo "Can't find ffmpeg, ffprobe or bc, make sure these are installed"
+  exit
+fi
+
+PIXEL_FORMAT=${PIXEL_FORMAT:-bgra}
+UPSCALE_FRAME_RATE=${UPSCALE_FRAME_RATE:-true}
+
+# Source resolution followed by some typical video sizes used by themes.
+SIZES="source 1280x720 640x480 400x300"
+
+printf "%-40s %-10s %-10s %16s\n" "File" "Size" "Decoded" "CPU ms/second"
+
+for file in "$@"; do
+  if [ ! -f "${file}" ]; then
+    echo "Can't find video file" ${file}
+    continue
+  fi
+
+  DURATION=$(ffprobe -v error -show_entries format=duration -of csv=p=0 "${file}")
+  VIDEO_SIZE=$(ffprobe -v error -select_streams v:0 -show_entries stream=width,height \
+    -of csv=s=x:p=0 "${file}")
+  VIDEO_WIDTH=$(echo ${VIDEO_SIZE} | cut -f1 -d"x")
+  VIDEO_HEIGHT=$(echo ${VIDEO_SIZE} | cut -f2 -d"x")
+
+  if [ -z "${DURATION}" ] || [ -z "${VIDEO_WIDTH}" ] || [ -z "${VIDEO_HEIGHT}" ]; then
+    echo "Couldn't get the duration or resolution for video file" ${file}
+    continue
+  fi
+
+  for size in ${SIZES}; do
+    DECODE_WIDTH=${VIDEO_WIDTH}
+    DECODE_HEIGHT=${VIDEO_HEIGHT}
+
+    if [ ${size} != source ]; then
+      TARGET_WIDTH=$(echo ${size} | cut -f1 -d"x")
+      TARGET_HEIGHT=$(echo ${size} | cut -f2 -d"x")
+      # Same as calculateDecodeSize(), never upscale and round up to even dimensions.
+      SCALE_FACTOR=$(echo "a = ${TARGET_WIDTH} / ${VIDEO_WIDTH}; \
+        b = ${TARGET_HEIGHT} / ${VIDEO_HEIGHT}; if (a < b) a else b" | bc -l)
+      if [ $(echo "${SCALE_FACTOR} < 1" | bc -l) -eq 1 ]; then
+        DECODE_WIDTH=$(echo "w = ${VIDEO_WIDTH} * ${SCALE_FACTOR} / 2; \
+          scale = 0; c = w / 1; if (c < w) c += 1; if (c < 1) c = 1; c * 2" | bc -l)
+        DECODE_HEIGHT=$(echo "h = ${VIDEO_HEIGHT} * ${SCALE_FACTOR} / 2; \
+          scale = 0; c = h / 1; if (c < h) c += 1; if (c < 1) c = 1; c * 2" | bc -l)
+        if [ ${DECODE_WIDTH} -ge ${VIDEO_WIDTH} ] || [ ${DECODE_HEIGHT} -ge ${VIDEO_HEIGHT} ]; then
+          DECODE_WIDTH=${VIDEO_WIDTH}
+          DECODE_HEIGHT=${VIDEO_HEIGHT}
+        fi
+      fi
+    fi
+
+    # Same as setupVideoFilters().
+    FILTERS=""
+    SCALE_FRAMES=false
+    if [ ${DECODE_WIDTH} -ne ${VIDEO_WIDTH} ] || [ ${DECODE_HEIGHT} -ne ${VIDEO_HEIGHT} ]; then
+      FILTERS="scale=width=${DECODE_WIDTH}:height=${DECODE_HEIGHT}:flags=bilinear,"
+      SCALE_FRAMES=true
+    fi
+
+    if [ ${UPSCALE_FRAME_RATE} = true ]; then
+      MODULO=$((VIDEO_WIDTH % 16))
+      if [ ${MODULO} -gt 0 ] && [ ${SCALE_FRAMES} = false ]; then
+        FILTERS+="scale=width=$((VIDEO_WIDTH + 16 - MODULO)):height=${VIDEO_HEIGHT},fps=fps=60,"
+      else
+        FILTERS+="fps=fps=60,"
+      fi
+    fi
+
+    FILTERS+="format=pix_fmts=${PIXEL_FORMAT}"
+
+    # The benchmark output is in the format "bench: utime=1.234s stime=0.123s rtime=1.000s".
+    BENCHMARK=$(ffmpeg -hide_banner -nostats -benchmark -i "${file}" -an \
+      -vf "${FILTERS}" -f null - 2>&1 | grep "bench: utime")
+
+    UTIME=$(echo ${BENCHMARK} | sed -E "s/.*utime=([0-9.]+)s.*/\1/")
+    STIME=$(echo ${BENCHMARK} | sed -E "s/.*stime=([0-9.]+)s.*/\1/")
+
+    if [ -z "${UTIME}" ] || [ -z "${STIME}" ]; then
+      echo "Couldn't decode video file" ${file}
+      continue 2
+    fi
+
+    CPU_TIME=$(echo "(${UTIME} + ${STIME}) * 1000 / ${DURATION}" | bc -l)
+    printf "%-40s %-10s %-10s %16.1f\n" "$(basename "${file}" | cut -c1-40)" ${size} \
+      ${DECODE_WIDTH}x${DECODE_HEIGHT} ${CPU_TIME}
+  done
+done